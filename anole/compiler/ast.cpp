@@ -8,16 +8,46 @@ Expr::~Expr() = default;
 DeclarationStmt::~DeclarationStmt() = default;
 MultiVarsDeclarationStmt::DeclVariable::~DeclVariable() = default;
 
-bool AST::is_integer_expr() noexcept
+bool AST::is_constant() noexcept
 {
     return false;
 }
 
-bool IntegerExpr::is_integer_expr() noexcept
+bool NoneExpr::is_constant() noexcept
 {
     return true;
 }
 
+bool IntegerExpr::is_constant() noexcept
+{
+    return true;
+}
+
+bool FloatExpr::is_constant() noexcept
+{
+    return true;
+}
+
+bool BoolExpr::is_constant() noexcept
+{
+    return true;
+}
+
+bool StringExpr::is_constant() noexcept
+{
+    return true;
+}
+
+bool ListExpr::is_constant() noexcept
+{
+    return constant;
+}
+
+bool DictExpr::is_constant() noexcept
+{
+    return constant;
+}
+
 bool AST::is_expr_stmt() noexcept
 {
     return false;
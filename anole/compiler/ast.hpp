@@ -37,8 +37,10 @@ struct with_locations
 struct AST
 {
     virtual ~AST() = 0;
-    virtual bool is_integer_expr() noexcept;
+    virtual bool is_constant() noexcept;
     virtual bool is_expr_stmt() noexcept;
+    // see optimizer.cpp, children are optimized in place
+    virtual void optimize();
     virtual void codegen(Code &) = 0;
 };
 
@@ -51,6 +53,10 @@ struct Stmt : AST
 struct Expr : AST
 {
     virtual ~Expr() = 0;
+    // return the constant folded from the expression, or nullptr
+    virtual Ptr<Expr> fold();
+    // only for constant expressions, return the index of the constant
+    virtual Size create_const(Code &);
     virtual void codegen(Code &) = 0;
 };
 
@@ -62,11 +68,14 @@ struct Block : AST
 
     StmtList statements;
 
+    void optimize() override;
     void codegen(Code &) override;
 };
 
 struct NoneExpr : Expr
 {
+    bool is_constant() noexcept override;
+    Size create_const(Code &) override;
     void codegen(Code &) override;
 };
 
@@ -80,7 +89,8 @@ struct IntegerExpr : Expr
         // ...
     }
 
-    bool is_integer_expr() noexcept override;
+    bool is_constant() noexcept override;
+    Size create_const(Code &) override;
     void codegen(Code &) override;
 };
 
@@ -94,6 +104,8 @@ struct FloatExpr : Expr
         // ...
     }
 
+    bool is_constant() noexcept override;
+    Size create_const(Code &) override;
     void codegen(Code &) override;
 };
 
@@ -107,6 +119,8 @@ struct BoolExpr : Expr
         // ...
     }
 
+    bool is_constant() noexcept override;
+    Size create_const(Code &) override;
     void codegen(Code &) override;
 };
 
@@ -115,6 +129,8 @@ struct StringExpr : Expr
     String value;
 
     StringExpr(String) noexcept;
+    bool is_constant() noexcept override;
+    Size create_const(Code &) override;
     void codegen(Code &) override;
 };
 
@@ -133,6 +149,7 @@ struct ParenOperatorExpr : Expr, with_location
 
     ParenOperatorExpr(Ptr<Expr> &&) noexcept;
     ParenOperatorExpr(Ptr<Expr> &&, ArgumentList &&) noexcept;
+    void optimize() override;
     void codegen(Code &) override;
 };
 
@@ -142,6 +159,8 @@ struct UnaryOperatorExpr : Expr, with_location
     Ptr<Expr> expr;
 
     UnaryOperatorExpr(Token, Ptr<Expr> &&) noexcept;
+    void optimize() override;
+    Ptr<Expr> fold() override;
     void codegen(Code &) override;
 };
 
@@ -151,6 +170,8 @@ struct BinaryOperatorExpr : Expr, with_location
     Ptr<Expr> lhs, rhs;
 
     BinaryOperatorExpr(Ptr<Expr> &&, Token, Ptr<Expr> &&) noexcept;
+    void optimize() override;
+    Ptr<Expr> fold() override;
     void codegen(Code &) override;
 };
 
@@ -165,6 +186,7 @@ struct LambdaExpr : Expr
 
     LambdaExpr(Ptr<Block> &&) noexcept;
     LambdaExpr(ParameterList &&, Ptr<Block> &&) noexcept;
+    void optimize() override;
     void codegen(Code &) override;
 };
 
@@ -174,6 +196,7 @@ struct DotExpr : Expr, with_location
     String name;
 
     DotExpr(Ptr<Expr> &&, String) noexcept;
+    void optimize() override;
     void codegen(Code &) override;
 };
 
@@ -181,6 +204,7 @@ struct EnumExpr : Expr
 {
     std::list<struct NormalDeclarationStmt> decls;
 
+    void optimize() override;
     void codegen(Code &) override;
 };
 
@@ -192,13 +216,19 @@ struct MatchExpr : Expr, with_locations
     Ptr<Expr> else_expr;
 
     MatchExpr() noexcept;
+    void optimize() override;
     void codegen(Code &) override;
 };
 
 struct ListExpr : Expr, with_location
 {
     ExprList exprs;
+    // all the elements are constant, set by the optimizer
+    bool constant = false;
 
+    bool is_constant() noexcept override;
+    void optimize() override;
+    Size create_const(Code &) override;
     void codegen(Code &) override;
 };
 
@@ -207,13 +237,19 @@ struct IndexExpr : Expr, with_location
     Ptr<Expr> expr, index;
 
     IndexExpr(Ptr<Expr> &&, Ptr<Expr> &&) noexcept;
+    void optimize() override;
     void codegen(Code &) override;
 };
 
 struct DictExpr : Expr
 {
     ExprList keys, values;
+    // keys are constant but lists or dicts, and values are constant
+    bool constant = false;
 
+    bool is_constant() noexcept override;
+    void optimize() override;
+    Size create_const(Code &) override;
     void codegen(Code &) override;
 };
 
@@ -228,6 +264,7 @@ struct ClassExpr : Expr
     DeclList members;
 
     ClassExpr(String, ArgumentList &&, DeclList &&) noexcept;
+    void optimize() override;
     void codegen(Code &) override;
 };
 
@@ -236,6 +273,7 @@ struct DelayExpr : Expr
     Ptr<Expr> expr;
 
     DelayExpr(Ptr<Expr> &&) noexcept;
+    void optimize() override;
     void codegen(Code &) override;
 };
 
@@ -244,6 +282,8 @@ struct QuesExpr : Expr, with_location
     Ptr<Expr> cond, true_expr, false_expr;
 
     QuesExpr(Ptr<Expr> &&, Ptr<Expr> &&, Ptr<Expr> &&) noexcept;
+    void optimize() override;
+    Ptr<Expr> fold() override;
     void codegen(Code &) override;
 };
 
@@ -288,6 +328,7 @@ struct ExprStmt : Stmt
 
     ExprStmt(Ptr<Expr> &&) noexcept;
     bool is_expr_stmt() noexcept override;
+    void optimize() override;
     void codegen(Code &) override;
 };
 
@@ -305,6 +346,7 @@ struct NormalDeclarationStmt : DeclarationStmt
     Ptr<Expr> expr;
 
     NormalDeclarationStmt(String, Ptr<Expr> &&, bool = false) noexcept;
+    void optimize() override;
     void codegen(Code &) override;
 };
 
@@ -350,6 +392,7 @@ struct MultiVarsDeclarationStmt : DeclarationStmt
 
     MultiVarsDeclarationStmt(DeclVariableList &&variables) noexcept;
     MultiVarsDeclarationStmt(DeclVariableList &&variables, ExprList &&exprs) noexcept;
+    void optimize() override;
     void codegen(Code &) override;
 };
 
@@ -386,6 +429,7 @@ struct ReturnStmt : Stmt
 
     ReturnStmt() noexcept;
     ReturnStmt(ExprList &&) noexcept;
+    void optimize() override;
     void codegen(Code &) override;
 };
 
@@ -396,15 +440,18 @@ struct IfElseStmt : Stmt, with_location
     Ptr<AST> false_branch;
 
     IfElseStmt(Ptr<Expr> &&, Ptr<Block> &&, Ptr<AST> &&) noexcept;
+    void optimize() override;
     void codegen(Code &) override;
 };
 
+// the condition is nullptr if it's always true
 struct WhileStmt : Stmt, with_location
 {
     Ptr<Expr> cond;
     Ptr<Block> block;
 
     WhileStmt(Ptr<Expr> &&, Ptr<Block> &&) noexcept;
+    void optimize() override;
     void codegen(Code &) override;
 };
 
@@ -414,6 +461,7 @@ struct DoWhileStmt : Stmt, with_location
     Ptr<Block> block;
 
     DoWhileStmt(Ptr<Expr> &&, Ptr<Block> &&) noexcept;
+    void optimize() override;
     void codegen(Code &) override;
 };
 
@@ -424,6 +472,7 @@ struct ForeachStmt : Stmt
     Ptr<Block> block;
 
     ForeachStmt(Ptr<Expr> &&, String, Ptr<Block> &&) noexcept;
+    void optimize() override;
     void codegen(Code &) override;
 };
 }
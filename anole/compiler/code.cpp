@@ -5,9 +5,10 @@
 #include "../objects/objects.hpp"
 
 #include <set>
+#include <cstdio>
 #include <fstream>
 
-#define OPRAND(TYPE) (std::any_cast<const TYPE &>(ins.oprand))
+#define OPRAND(TYPE) (oprand_at<TYPE>(i))
 
 namespace anole
 {
@@ -85,7 +86,7 @@ class Printer
         {
             lens_.push_back(0);
         }
-        if (str.size() > lens_[line.size()])
+        if (str.size() >= lens_[line.size()])
         {
             lens_[line.size()] = (str.size() / 4 + 1) * 4;
         }
@@ -178,14 +179,14 @@ void typein(std::istream &in, std::pair<T1, T2> &pir)
 
 Code::Code(String from, const std::filesystem::path &path)
   : from_(std::move(from)), path_(std::make_shared<std::filesystem::path>(path))
-  , constants_{ NoneObject::one(), BoolObject::the_true(), BoolObject::the_false() }
+  , constants_{ Value::none(), Value::boolean(true), Value::boolean(false) }
 {
     // ...
 }
 
 Code::Code(String from, SPtr<std::filesystem::path> path) noexcept
   : from_(std::move(from)), path_(std::move(path))
-  , constants_{ NoneObject::one(), BoolObject::the_true(), BoolObject::the_false() }
+  , constants_{ Value::none(), Value::boolean(true), Value::boolean(false) }
 {
     // ...
 }
@@ -210,6 +211,11 @@ void Code::locate(const Location &location)
     source_mapping_[instructions_.size()] = location;
 }
 
+const Instruction *Code::instructions() const noexcept
+{
+    return instructions_.data();
+}
+
 const Instruction &Code::ins_at(Size i) const
 {
     return instructions_[i];
@@ -220,11 +226,56 @@ const Opcode &Code::opcode_at(Size i) const
     return instructions_[i].opcode;
 }
 
-const std::any &Code::oprand_at(Size i) const
+const Oprand &Code::oprand_at(Size i) const
 {
     return instructions_[i].oprand;
 }
 
+Size Code::create_name(const String &name)
+{
+    auto atom = Atoms::intern(name);
+    auto find = names_mapping_.find(atom);
+    if (find != names_mapping_.end())
+    {
+        return find->second;
+    }
+    atoms_.push_back(atom);
+    return names_mapping_[atom] = atoms_.size() - 1;
+}
+
+const String &Code::name_at(Size ind) const
+{
+    return Atoms::name(atoms_[ind]);
+}
+
+Size Code::add_load_member(const String &name)
+{
+    member_caches_.emplace_back();
+    return add_ins({ Opcode::LoadMember,
+        pack_oprand(member_caches_.size() - 1, create_name(name))
+    });
+}
+
+Oprand Code::to_oprand(Size value)
+{
+    return value;
+}
+
+Oprand Code::to_oprand(const String &name)
+{
+    return create_name(name);
+}
+
+Oprand Code::to_oprand(const std::pair<Size, Size> &pir)
+{
+    return pack_oprand(pir.first, pir.second);
+}
+
+Oprand Code::to_oprand(const std::pair<String, Size> &pir)
+{
+    return pack_oprand(create_name(pir.first), pir.second);
+}
+
 Size Code::add_ins(Instruction ins)
 {
     instructions_.push_back(std::move(ins));
@@ -290,9 +341,85 @@ bool Code::check()
     return true;
 }
 
-Object *Code::load_const(Size ind)
+Size Code::create_aggregate(char kind, const std::vector<Size> &elements)
+{
+    String key{kind};
+    for (auto ind : elements)
+    {
+        key += std::to_string(ind) + ',';
+    }
+
+    if (constants_mapping_.count(key))
+    {
+        return constants_mapping_[key];
+    }
+    else
+    {
+        constants_mapping_[key] = constants_.size();
+        constants_literals_.push_back(key);
+        constants_.push_back(build_aggregate(key));
+        return constants_.size() - 1;
+    }
+}
+
+String Code::float_key(double value)
 {
-    return constants_[ind];
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "f%.17g", value);
+    return buf;
+}
+
+/**
+ * keys of dicts are objects, immediate ones are boxed by new
+ *  like other constants instead of in the heap
+*/
+Value Code::build_aggregate(const String &key)
+{
+    std::vector<Value> elements;
+    Size ind = 0;
+    for (auto it = key.begin() + 1; it != key.end(); ++it)
+    {
+        if (*it == ',')
+        {
+            elements.push_back(constants_[ind]);
+            ind = 0;
+        }
+        else
+        {
+            ind = ind * 10 + (*it - '0');
+        }
+    }
+
+    if (key[0] == 'l')
+    {
+        auto list = new ListObject();
+        for (auto &element : elements)
+        {
+            list->append(element);
+        }
+        return list;
+    }
+
+    auto dict = new DictObject();
+    for (Size i = 0; i < elements.size(); i += 2)
+    {
+        auto &k = elements[i];
+        Object *obj;
+        if (k.is_integer())
+        {
+            obj = new IntegerObject(k.as_integer());
+        }
+        else if (k.is_float())
+        {
+            obj = new FloatObject(k.as_float());
+        }
+        else
+        {
+            obj = k.box();
+        }
+        dict->insert(obj, elements[i + 1]);
+    }
+    return dict;
 }
 
 void Code::print(const std::filesystem::path &path)
@@ -317,6 +444,18 @@ void Code::print(std::ostream &out)
     printer.print();
     printer.clear();
 
+    printer.add_intro("Names:");
+    printer.add_line("NI", "Name");
+
+    for (Size i = 0; i < atoms_.size(); ++i)
+    {
+        printer.add_line(i, name_at(i));
+    }
+
+    printer.add_line();
+    printer.print();
+    printer.clear();
+
     printer.add_intro("Instructions:");
     printer.add_line("L", "Opcode", "Oprand");
 
@@ -364,6 +503,24 @@ void Code::print(std::ostream &out)
             printer.add_line(i, "StoreLocal", OPRAND(String));
             break;
 
+        case Opcode::LoadLocal:
+            printer.add_line(i, "LoadLocal",
+                std::make_pair(OPRAND(String), variable_slot(OPRAND(Size))));
+            break;
+        case Opcode::LoadUpvalue:
+            printer.add_line(i, "LoadUpvalue",
+                std::make_pair(OPRAND(String), std::make_pair(
+                    variable_depth(OPRAND(Size)), variable_slot(OPRAND(Size)))));
+            break;
+        case Opcode::StoreSlot:
+            printer.add_line(i, "StoreSlot",
+                std::make_pair(OPRAND(String), variable_slot(OPRAND(Size))));
+            break;
+        case Opcode::StoreRefSlot:
+            printer.add_line(i, "StoreRefSlot",
+                std::make_pair(OPRAND(String), variable_slot(OPRAND(Size))));
+            break;
+
         case Opcode::NewScope:
             printer.add_line(i, "NewScope");
             break;
@@ -380,6 +537,12 @@ void Code::print(std::ostream &out)
         case Opcode::FastCall:
             printer.add_line(i, "FastCall", OPRAND(Size));
             break;
+        case Opcode::TailCall:
+            printer.add_line(i, "TailCall");
+            break;
+        case Opcode::FastTailCall:
+            printer.add_line(i, "FastTailCall", OPRAND(Size));
+            break;
         case Opcode::Return:
             printer.add_line(i, "Return");
             break;
@@ -497,9 +660,100 @@ void Code::print(std::ostream &out)
         case Opcode::BuildDict:
             printer.add_line(i, "BuildDict", OPRAND(Size));
             break;
+        case Opcode::CopyConst:
+            printer.add_line(i, "CopyConst", OPRAND(Size));
+            break;
         case Opcode::BuildClass:
             printer.add_line(i, "BuildClass", OPRAND(String));
             break;
+
+        case Opcode::LoadLoadAdd:
+            printer.add_line(i, "LoadLoadAdd", OPRAND(String));
+            break;
+        case Opcode::LoadConstAdd:
+            printer.add_line(i, "LoadConstAdd", OPRAND(String));
+            break;
+        case Opcode::LoadConstSub:
+            printer.add_line(i, "LoadConstSub", OPRAND(String));
+            break;
+        case Opcode::LoadStorePop:
+            printer.add_line(i, "LoadStorePop", OPRAND(String));
+            break;
+        case Opcode::StorePop:
+            printer.add_line(i, "StorePop");
+            break;
+        case Opcode::CEQJumpIfNot:
+            printer.add_line(i, "CEQJumpIfNot");
+            break;
+        case Opcode::CNEJumpIfNot:
+            printer.add_line(i, "CNEJumpIfNot");
+            break;
+        case Opcode::CLTJumpIfNot:
+            printer.add_line(i, "CLTJumpIfNot");
+            break;
+        case Opcode::CLEJumpIfNot:
+            printer.add_line(i, "CLEJumpIfNot");
+            break;
+        case Opcode::CallMethod:
+            printer.add_line(i, "CallMethod", OPRAND(String));
+            break;
+        case Opcode::AddIntInt:
+            printer.add_line(i, "AddIntInt");
+            break;
+        case Opcode::SubIntInt:
+            printer.add_line(i, "SubIntInt");
+            break;
+        case Opcode::MulIntInt:
+            printer.add_line(i, "MulIntInt");
+            break;
+        case Opcode::CEQIntInt:
+            printer.add_line(i, "CEQIntInt");
+            break;
+        case Opcode::CNEIntInt:
+            printer.add_line(i, "CNEIntInt");
+            break;
+        case Opcode::CLTIntInt:
+            printer.add_line(i, "CLTIntInt");
+            break;
+        case Opcode::CLEIntInt:
+            printer.add_line(i, "CLEIntInt");
+            break;
+        case Opcode::AddFloatFloat:
+            printer.add_line(i, "AddFloatFloat");
+            break;
+        case Opcode::SubFloatFloat:
+            printer.add_line(i, "SubFloatFloat");
+            break;
+        case Opcode::MulFloatFloat:
+            printer.add_line(i, "MulFloatFloat");
+            break;
+        case Opcode::DivFloatFloat:
+            printer.add_line(i, "DivFloatFloat");
+            break;
+        case Opcode::CLTFloatFloat:
+            printer.add_line(i, "CLTFloatFloat");
+            break;
+        case Opcode::CLEFloatFloat:
+            printer.add_line(i, "CLEFloatFloat");
+            break;
+        case Opcode::CEQIntIntJumpIfNot:
+            printer.add_line(i, "CEQIntIntJumpIfNot");
+            break;
+        case Opcode::CNEIntIntJumpIfNot:
+            printer.add_line(i, "CNEIntIntJumpIfNot");
+            break;
+        case Opcode::CLTIntIntJumpIfNot:
+            printer.add_line(i, "CLTIntIntJumpIfNot");
+            break;
+        case Opcode::CLEIntIntJumpIfNot:
+            printer.add_line(i, "CLEIntIntJumpIfNot");
+            break;
+        case Opcode::LoadBuiltin:
+            printer.add_line(i, "LoadBuiltin", OPRAND(String));
+            break;
+        case Opcode::LoadGlobal:
+            printer.add_line(i, "LoadGlobal", OPRAND(String));
+            break;
         }
     }
     printer.print();
@@ -516,6 +770,7 @@ void Code::serialize(std::ostream &out)
     typeout(out, theMagic);
 
     typeouts(out, constants_literals_.size(),
+                  atoms_.size(),
                   instructions_.size(),
                   source_mapping_.size()
     );
@@ -523,18 +778,28 @@ void Code::serialize(std::ostream &out)
     for (Size i = 0; i < constants_literals_.size(); ++i)
     {
         auto &cl = constants_literals_[i];
-        auto &obj = constants_[i + 3];
+        auto &value = constants_[i + 3];
 
         out.put(cl[0]);
         switch (cl[0])
         {
         case 'i':
-            typeout(out, reinterpret_cast<IntegerObject *>(obj)->value());
+        {
+            int64_t val = 0;
+            value.get_integer(val);
+            typeout(out, val);
+        }
             break;
         case 'f':
-            typeout(out, reinterpret_cast<FloatObject *>(obj)->value());
+        {
+            double val = 0;
+            value.get_float(val);
+            typeout(out, val);
+        }
             break;
         case 's':
+        case 'l':
+        case 'd':
             typeout(out, cl.substr(1));
             break;
 
@@ -543,54 +808,16 @@ void Code::serialize(std::ostream &out)
         }
     }
 
-    for (auto &ins : instructions_)
+    for (auto atom : atoms_)
     {
-        out.put(static_cast<uint8_t>(ins.opcode));
-        switch (ins.opcode)
-        {
-        case Opcode::Pop:
-        case Opcode::LoadConst:
-        case Opcode::FastCall:
-        case Opcode::Jump:
-        case Opcode::JumpIf:
-        case Opcode::JumpIfNot:
-        case Opcode::Match:
-        case Opcode::Unpack:
-        case Opcode::ThunkDecl:
-        case Opcode::BuildList:
-        case Opcode::BuildDict:
-            typeout(out, OPRAND(Size));
-            break;
-
-        case Opcode::Import:
-        case Opcode::ImportPath:
-        case Opcode::ImportPart:
-        case Opcode::Load:
-        case Opcode::LoadMember:
-        case Opcode::StoreRef:
-        case Opcode::StoreLocal:
-        case Opcode::AddPrefixOp:
-        case Opcode::BuildClass:
-            typeout(out, OPRAND(String));
-            break;
-
-        case Opcode::AddInfixOp:
-        {
-            using type = std::pair<String, Size>;
-            typeout(out, OPRAND(type));
-        }
-            break;
-
-        case Opcode::LambdaDecl:
-        {
-            using type = std::pair<Size, Size>;
-            typeout(out, OPRAND(type));
-        }
-            break;
+        typeout(out, Atoms::name(atom));
+    }
 
-        default:
-            break;
-        }
+    // quickened instructions are saved as generic ones
+    for (auto &ins : instructions_)
+    {
+        out.put(static_cast<uint8_t>(generic_opcode(ins.opcode)));
+        typeout(out, ins.oprand);
     }
 
     for (auto &line_pos : source_mapping_)
@@ -608,7 +835,7 @@ bool Code::unserialize(const std::filesystem::path &path)
     return unserialize(fin);
 }
 
-bool Code::unserialize(std::ifstream &in)
+bool Code::unserialize(std::istream &in)
 {
     Magic magic; typein(in, magic);
     if (magic != theMagic)
@@ -617,10 +844,11 @@ bool Code::unserialize(std::ifstream &in)
     }
 
     Size constants_size = 0,
+         names_size = 0,
          instructions_size = 0,
          mapping_size = 0
     ;
-    typeins(in, constants_size, instructions_size, mapping_size);
+    typeins(in, constants_size, names_size, instructions_size, mapping_size);
 
     while (constants_size --> 0)
     {
@@ -632,7 +860,7 @@ bool Code::unserialize(std::ifstream &in)
             int64_t val;
             typein(in, val);
             constants_literals_.push_back(type + std::to_string(val));
-            constants_.push_back(new IntegerObject(val));
+            constants_.push_back(to_constant<IntegerObject>(val));
         }
             break;
 
@@ -640,8 +868,8 @@ bool Code::unserialize(std::ifstream &in)
         {
             double val;
             typein(in, val);
-            constants_literals_.push_back(type + std::to_string(val));
-            constants_.push_back(new FloatObject(val));
+            constants_literals_.push_back(float_key(val));
+            constants_.push_back(to_constant<FloatObject>(val));
         }
             break;
 
@@ -654,71 +882,43 @@ bool Code::unserialize(std::ifstream &in)
         }
             break;
 
+        case 'l':
+        case 'd':
+        {
+            String val;
+            typein(in, val);
+            constants_literals_.push_back(type + val);
+            constants_.push_back(build_aggregate(type + val));
+        }
+            break;
+
         default:
             throw std::runtime_error("WTF, you want me to eat shit?!");
         }
     }
 
+    while (names_size --> 0)
+    {
+        String name;
+        typein(in, name);
+        create_name(name);
+    }
+
     while (instructions_size --> 0)
     {
         Opcode opcode = Opcode(in.get());
-        std::any oprand = {};
-        switch (opcode)
-        {
-        case Opcode::Pop:
-        case Opcode::LoadConst:
-        case Opcode::FastCall:
-        case Opcode::Jump:
-        case Opcode::JumpIf:
-        case Opcode::JumpIfNot:
-        case Opcode::Match:
-        case Opcode::Unpack:
-        case Opcode::ThunkDecl:
-        case Opcode::BuildList:
-        case Opcode::BuildDict:
-        {
-            Size val;
-            typein(in, val);
-            oprand = val;
-        }
-            break;
-
-        case Opcode::Import:
-        case Opcode::ImportPath:
-        case Opcode::ImportPart:
-        case Opcode::Load:
-        case Opcode::LoadMember:
-        case Opcode::StoreRef:
-        case Opcode::StoreLocal:
-        case Opcode::AddPrefixOp:
-        case Opcode::BuildClass:
-        {
-            String val;
-            typein(in, val);
-            oprand = val;
-        }
-            break;
-
-        case Opcode::AddInfixOp:
-        {
-            std::pair<String, Size> val;
-            typein(in, val);
-            oprand = val;
-        }
-            break;
+        Oprand oprand;
+        typein(in, oprand);
+        instructions_.push_back(Instruction{ opcode, oprand });
 
-        case Opcode::LambdaDecl:
+        if (opcode == Opcode::LoadMember || opcode == Opcode::CallMethod)
         {
-            std::pair<Size, Size> val;
-            typein(in, val);
-            oprand = val;
-        }
-            break;
-
-        default:
-            break;
+            auto cache = unpack_oprand(oprand).first;
+            if (cache >= member_caches_.size())
+            {
+                member_caches_.resize(cache + 1);
+            }
         }
-        instructions_.push_back(Instruction{ opcode, oprand });
     }
 
     while (mapping_size --> 0)
@@ -4,7 +4,8 @@
 #include "ast.hpp"
 #include "instruction.hpp"
 
-#include "../objects/object.hpp"
+#include "../objects/value.hpp"
+#include "../runtime/scope.hpp"
 #include "../runtime/allocator.hpp"
 
 #include <map>
@@ -17,7 +18,11 @@ namespace anole
 {
 class Code
 {
+    friend class Aot;
+    friend class Jit;
     friend class Collector;
+    friend class Peephole;
+    friend class Resolver;
 
   public:
     Code(String from, const std::filesystem::path &path);
@@ -29,35 +34,146 @@ class Code
     std::map<Size, Location> &source_mapping();
     void locate(const Location &location);
 
+    const Instruction *instructions() const noexcept;
     const Instruction &ins_at(Size i) const;
     const Opcode &opcode_at(Size i) const;
-    const std::any &oprand_at(Size i) const;
+    const Oprand &oprand_at(Size i) const;
+
+    /**
+     * decode the oprand of the i-th instruction as the given type,
+     *  names will be resolved by the name table
+    */
+    template<typename T>
+    decltype(auto) oprand_at(Size i) const
+    {
+        const auto &oprand = instructions_[i].oprand;
+        if constexpr (std::is_same_v<T, String>)
+        {
+            return name_at(variable_name(oprand));
+        }
+        else if constexpr (std::is_same_v<T, Atom>)
+        {
+            return atom_at(variable_name(oprand));
+        }
+        else if constexpr (std::is_same_v<T, std::pair<String, Size>>)
+        {
+            auto pir = unpack_oprand(oprand);
+            return std::make_pair(name_at(pir.first), pir.second);
+        }
+        else if constexpr (std::is_same_v<T, std::pair<Size, Size>>)
+        {
+            return unpack_oprand(oprand);
+        }
+        else
+        {
+            static_assert(std::is_same_v<T, Size>);
+            return oprand;
+        }
+    }
+
+    Size create_name(const String &name);
+    const String &name_at(Size ind) const;
+    Atom atom_at(Size ind) const noexcept
+    {
+        return atoms_[ind];
+    }
+
+    /**
+     * each LoadMember has its own inline cache,
+     *  the index of which is in the high 32 bits of the oprand
+    */
+    Size add_load_member(const String &name);
+    MemberCache &member_cache(Size ind) noexcept
+    {
+        return member_caches_[ind];
+    }
+
+    /**
+     * each generic instruction which can be quickened has a counter
+     *  of executions with oprands of the same types in a row,
+     *  it's quickened when the counter reaches kQuickenThreshold
+    */
+    static constexpr uint8_t kQuickenThreshold = 16;
+
+    bool heat_up(Size ind)
+    {
+        if (ind >= hotness_.size())
+        {
+            hotness_.resize(instructions_.size());
+        }
+        return ++hotness_[ind] >= kQuickenThreshold;
+    }
+
+    void cool_down(Size ind) noexcept
+    {
+        if (ind < hotness_.size())
+        {
+            hotness_[ind] = 0;
+        }
+    }
+
+    void quicken(Size ind, Opcode op) noexcept
+    {
+        instructions_[ind].opcode = op;
+        cool_down(ind);
+    }
+
+    void unquicken(Size ind) noexcept
+    {
+        quicken(ind, generic_opcode(instructions_[ind].opcode));
+    }
+
+    // each LoadGlobal keeps the variable it loads in its cell
+    Address &global_cell(Size ind)
+    {
+        if (ind >= global_cells_.size())
+        {
+            global_cells_.resize(instructions_.size());
+        }
+        return global_cells_[ind];
+    }
+
+    /**
+     * functions and loops are counted by their first instructions
+     *  and compiled by Jit when they get hot, see jit.hpp,
+     *  each instruction compiled has its entry into native code
+    */
+    const void *native_entry(Size ind) const noexcept
+    {
+        return ind < native_entries_.size() ? native_entries_[ind] : nullptr;
+    }
+
+    // codes loaded from modules compiled by Aot have entries of functions
+    const void *aot_entry(Size ind) const noexcept
+    {
+        return ind < aot_entries_.size() ? aot_entries_[ind] : nullptr;
+    }
 
     Size add_ins(Instruction ins);
     template<Opcode op = Opcode::PlaceHolder>
     Size add_ins()
     {
-        instructions_.push_back({ op });
+        instructions_.push_back({ op, 0 });
         return instructions_.size() - 1;
     }
 
     template<Opcode op, typename T>
     Size add_ins(const T &value)
     {
-        instructions_.push_back({ op, value });
+        instructions_.push_back({ op, to_oprand(value) });
         return instructions_.size() - 1;
     }
 
     template<Opcode op>
     void set_ins(Size ind)
     {
-        instructions_[ind] = { op };
+        instructions_[ind] = { op, 0 };
     }
 
     template<Opcode op, typename T>
     void set_ins(Size ind, const T &value)
     {
-        instructions_[ind] = { op, value };
+        instructions_[ind] = { op, to_oprand(value) };
     }
 
     Size size() const noexcept;
@@ -67,7 +183,10 @@ class Code
     void set_continue_to(Size ind, Size base);
     bool check();
 
-    Object *load_const(Size ind);
+    Value load_const(Size ind) const noexcept
+    {
+        return constants_[ind];
+    }
 
     template<typename O, typename T>
     Size create_const(String key, T value)
@@ -82,17 +201,21 @@ class Code
         {
             constants_mapping_[key] = constants_.size();
             constants_literals_.push_back(key);
-            /**
-             * TODO:
-             *
-             * constants won't be deallocated now
-             *  although the code is released
-            */
-            constants_.push_back(new O(value));
+            constants_.push_back(to_constant<O>(value));
             return constants_.size() - 1;
         }
     }
 
+    /**
+     * constant lists and dicts are built from constants before them,
+     *  they are keyed by their kinds, 'l' or 'd', and indices of them,
+     *  and never changed but copied by CopyConst
+    */
+    Size create_aggregate(char kind, const std::vector<Size> &elements);
+
+    // floats are keyed by all their digits, or close ones would be merged
+    static String float_key(double value);
+
     void print(const std::filesystem::path &path);
     void print(std::ostream &out = std::cout);
 
@@ -100,10 +223,46 @@ class Code
     void serialize(std::ostream &out);
 
     bool unserialize(const std::filesystem::path &path);
-    bool unserialize(std::ifstream &in);
+    bool unserialize(std::istream &in);
 
     void clear();
 
+  private:
+    /**
+     * integers and floats are immediate if possible
+     *
+     * boxed constants are kept until exit even if the code is released,
+     *  they are pushed and bound to variables as they are,
+     *  so they may outlive the code, like results of eval,
+     *  and they are not in the heap, so the collector never frees them
+     *
+     * only codes of eval are released before exit,
+     *  and each of them keeps no more than the constants of its source
+    */
+    template<typename O, typename T>
+    static Value to_constant(T value)
+    {
+        if constexpr (std::is_same_v<T, double>)
+        {
+            return Value::floating(value);
+        }
+        else if constexpr (std::is_integral_v<T>)
+        {
+            if (Value::fits_integer(value))
+            {
+                return Value::integer(value);
+            }
+        }
+        return new O(value);
+    }
+
+    Value build_aggregate(const String &key);
+
+    Oprand to_oprand(Size value);
+    Oprand to_oprand(const String &name);
+    Oprand to_oprand(const std::pair<Size, Size> &pir);
+    Oprand to_oprand(const std::pair<String, Size> &pir);
+
   private:
     String from_;
     /**
@@ -114,12 +273,29 @@ class Code
     std::map<Size, Location> source_mapping_;
 
     std::vector<Instruction> instructions_;
+    // names are interned, see atom.hpp
+    std::vector<Atom> atoms_;
+    std::map<Atom, Size> names_mapping_;
     // these two should be checked is empty or not
     std::vector<Size> breaks_, continues_;
     std::vector<String> constants_literals_;
 
     std::map<String, Size> constants_mapping_;
-    std::vector<Object *> constants_;
+    std::vector<Value> constants_;
+
+    std::vector<MemberCache> member_caches_;
+    std::vector<uint8_t> hotness_;
+    std::vector<Address> global_cells_;
+    std::vector<uint32_t> native_hotness_;
+    std::vector<const void *> native_entries_;
+    std::vector<const void *> aot_entries_;
+
+    /**
+     * slots of variables declared at the top level,
+     *  kept by the resolver because codes are generated incrementally
+    */
+    std::map<Atom, Size> top_slots_;
+    bool top_dynamic_ = false;
 };
 }
 
@@ -15,41 +15,61 @@ void Block::codegen(Code &code)
     }
 }
 
+Size Expr::create_const(Code &)
+{
+    throw std::runtime_error("WTF, here is a bug!");
+}
+
+Size NoneExpr::create_const(Code &)
+{
+    return 0;
+}
+
 void NoneExpr::codegen(Code &code)
 {
-    code.add_ins<Opcode::LoadConst, Size>(0);
+    code.add_ins<Opcode::LoadConst, Size>(create_const(code));
 }
 
-void IntegerExpr::codegen(Code &code)
+Size IntegerExpr::create_const(Code &code)
 {
-    code.add_ins<Opcode::LoadConst, Size>(
-        code.create_const<IntegerObject>(
-            'i' + std::to_string(value), value
-        )
+    return code.create_const<IntegerObject>(
+        'i' + std::to_string(value), value
     );
 }
 
+void IntegerExpr::codegen(Code &code)
+{
+    code.add_ins<Opcode::LoadConst, Size>(create_const(code));
+}
+
+Size FloatExpr::create_const(Code &code)
+{
+    return code.create_const<FloatObject>(Code::float_key(value), value);
+}
+
 void FloatExpr::codegen(Code &code)
 {
-    code.add_ins<Opcode::LoadConst, Size>(
-        code.create_const<FloatObject>(
-            'f' + std::to_string(value), value
-        )
-    );
+    code.add_ins<Opcode::LoadConst, Size>(create_const(code));
+}
+
+Size BoolExpr::create_const(Code &)
+{
+    return value ? 1 : 2;
 }
 
 void BoolExpr::codegen(Code &code)
 {
-    code.add_ins<Opcode::LoadConst, Size>(value ? 1 : 2);
+    code.add_ins<Opcode::LoadConst, Size>(create_const(code));
+}
+
+Size StringExpr::create_const(Code &code)
+{
+    return code.create_const<StringObject>('s' + value, value);
 }
 
 void StringExpr::codegen(Code &code)
 {
-    code.add_ins<Opcode::LoadConst, Size>(
-        code.create_const<StringObject>(
-            's' + value, value
-        )
-    );
+    code.add_ins<Opcode::LoadConst, Size>(create_const(code));
 }
 
 void IdentifierExpr::codegen(Code &code)
@@ -296,14 +316,14 @@ void BinaryOperatorExpr::codegen(Code &code)
         rhs->codegen(code);
         lhs->codegen(code);
         code.locate(location);
-        code.add_ins<Opcode::CLE>();
+        code.add_ins<Opcode::CLT>();
         break;
 
     case TokenType::CGE:
         rhs->codegen(code);
         lhs->codegen(code);
         code.locate(location);
-        code.add_ins<Opcode::CLT>();
+        code.add_ins<Opcode::CLE>();
         break;
 
     default:
@@ -340,7 +360,7 @@ void DotExpr::codegen(Code &code)
 {
     left->codegen(code);
     code.locate(location);
-    code.add_ins<Opcode::LoadMember, String>(name);
+    code.add_load_member(name);
 }
 
 void EnumExpr::codegen(Code &code)
@@ -390,8 +410,24 @@ void MatchExpr::codegen(Code &code)
     }
 }
 
+Size ListExpr::create_const(Code &code)
+{
+    std::vector<Size> elements;
+    for (auto &expr : exprs)
+    {
+        elements.push_back(expr->create_const(code));
+    }
+    return code.create_aggregate('l', elements);
+}
+
 void ListExpr::codegen(Code &code)
 {
+    if (constant)
+    {
+        code.add_ins<Opcode::CopyConst, Size>(create_const(code));
+        return;
+    }
+
     for (auto it = exprs.rbegin();
         it != exprs.rend(); ++it)
     {
@@ -409,8 +445,26 @@ void IndexExpr::codegen(Code &code)
     code.add_ins<Opcode::Index>();
 }
 
+Size DictExpr::create_const(Code &code)
+{
+    std::vector<Size> elements;
+    auto value = values.begin();
+    for (auto &key : keys)
+    {
+        elements.push_back(key->create_const(code));
+        elements.push_back((*value++)->create_const(code));
+    }
+    return code.create_aggregate('d', elements);
+}
+
 void DictExpr::codegen(Code &code)
 {
+    if (constant)
+    {
+        code.add_ins<Opcode::CopyConst, Size>(create_const(code));
+        return;
+    }
+
     auto rbegin_values = values.rbegin();
     auto rbegin_keys = keys.rbegin();
     while (rbegin_values != values.rend())
@@ -671,6 +725,28 @@ void ReturnStmt::codegen(Code &code)
         {
             code.add_ins<Opcode::BuildList, Size>(exprs.size());
         }
+        else
+        {
+            /**
+             * the call whose result is returned directly is a tail call,
+             *  it's the last instruction of the expression
+             *  and other branches of the expression still reach the Return
+            */
+            auto last = code.size() - 1;
+            switch (code.opcode_at(last))
+            {
+            case Opcode::Call:
+                code.set_ins<Opcode::TailCall>(last);
+                break;
+
+            case Opcode::FastCall:
+                code.set_ins<Opcode::FastTailCall, Size>(last, code.oprand_at(last));
+                break;
+
+            default:
+                break;
+            }
+        }
 
         code.add_ins<Opcode::Return>();
     }
@@ -701,6 +777,15 @@ void IfElseStmt::codegen(Code &code)
 void WhileStmt::codegen(Code &code)
 {
     auto o1 = code.size();
+    if (!cond)
+    {
+        block->codegen(code);
+        code.add_ins<Opcode::Jump>(o1);
+        code.set_break_to(code.size(), o1);
+        code.set_continue_to(o1, o1);
+        return;
+    }
+
     cond->codegen(code);
     code.locate(location);
     auto o2 = code.add_ins();
@@ -743,7 +828,7 @@ void ForeachStmt::codegen(Code &code)
     /**
      * generate code for: @& //__it: expr.__iterator__();
     */
-    code.add_ins<Opcode::LoadMember, String>("__iterator__");
+    code.add_load_member("__iterator__");
     code.add_ins<Opcode::FastCall, Size>(0);
 
     auto it_name = "//__it_" + std::to_string(code.size());
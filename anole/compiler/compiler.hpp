@@ -4,7 +4,10 @@
 #include "ast.hpp"
 #include "code.hpp"
 #include "token.hpp"
+#include "optimizer.hpp"
 #include "parser.hpp"
+#include "peephole.hpp"
+#include "resolver.hpp"
 #include "tokenizer.hpp"
 #include "instruction.hpp"
 
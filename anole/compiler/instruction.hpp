@@ -1,7 +1,9 @@
 #ifndef __ANOLE_INSTRUCTION_HPP__
 #define __ANOLE_INSTRUCTION_HPP__
 
-#include <any>
+#include "../base.hpp"
+
+#include <utility>
 
 namespace anole
 {
@@ -18,17 +20,36 @@ enum class Opcode : uint8_t
 
     Load,         // Load name
     LoadConst,    // LoadConst index
-    LoadMember,   // LoadMember name
+    LoadMember,   // LoadMember (cache, name)
     Store,        // Store
     StoreRef,     // StoreRef name
     StoreLocal,   // StoreLocal name
 
+    /**
+     * variables resolved by the resolver are referenced by slots
+     *  of scopes, see pack_variable for their oprands
+    */
+    LoadLocal,    // LoadLocal (name, slot)
+    LoadUpvalue,  // LoadUpvalue (name, depth, slot)
+    StoreSlot,    // StoreSlot (name, slot), of StoreLocal name
+    StoreRefSlot, // StoreRefSlot (name, slot), of StoreRef name
+
     NewScope,     // NewScope
     EndScope,     // EndScope
 
     CallAc,       // CallAc
     Call,         // Call
     FastCall,     // FastCall num
+
+    /**
+     * calls returned directly are tail calls, whose callees
+     *  replace frames of callers and return to where they would return,
+     *  the Return following them is only executed for callees
+     *  which don't run in new frames, like built-in functions
+    */
+    TailCall,     // TailCall, of Call; Return
+    FastTailCall, // FastTailCall num, of FastCall num; Return
+
     Return,       // Return
     ReturnNone,   // ReturnNone
     Jump,         // Jump target
@@ -71,14 +92,172 @@ enum class Opcode : uint8_t
     BuildEnum,    // BuildEnum
     BuildList,    // BuildList num
     BuildDict,    // BuildDict num
+    /**
+     * constant lists and dicts are built once in the constant pool,
+     *  each execution pushes a copy of it, see Code::create_aggregate
+    */
+    CopyConst,    // CopyConst index
     BuildClass,   // BuildClass name
+
+    /**
+     * superinstructions are only rewritten from the heads of sequences
+     *  by the peephole pass and keep oprands of the heads,
+     *  the rest of each sequence is left in place
+     *  so that it can still be jumped into
+     *  or executed when the fast path is not taken
+    */
+    LoadLoadAdd,  // LoadLoadAdd var, of Load var; Load var; Add
+    LoadConstAdd, // LoadConstAdd var, of Load var; LoadConst index; Add
+    LoadConstSub, // LoadConstSub var, of Load var; LoadConst index; Sub
+    LoadStorePop, // LoadStorePop var, of Load var; Store; Pop 1
+    StorePop,     // StorePop, of Store; Pop 1
+    CEQJumpIfNot, // CEQJumpIfNot, of CEQ; JumpIfNot target
+    CNEJumpIfNot, // CNEJumpIfNot, of CNE; JumpIfNot target
+    CLTJumpIfNot, // CLTJumpIfNot, of CLT; JumpIfNot target
+    CLEJumpIfNot, // CLEJumpIfNot, of CLE; JumpIfNot target
+    CallMethod,   // CallMethod (cache, name), of LoadMember (cache, name); FastCall num
+                  //  or FastTailCall num
+
+    /**
+     * quickened instructions are rewritten in place from generic ones
+     *  at runtime when they get hot with oprands of the same types,
+     *  and rewritten back to generic ones when the types change
+     *
+     * they are never generated by the compiler or saved in caches,
+     *  see generic_opcode for their generic ones
+    */
+    AddIntInt,                // AddIntInt, of Add
+    SubIntInt,                // SubIntInt, of Sub
+    MulIntInt,                // MulIntInt, of Mul
+    CEQIntInt,                // CEQIntInt, of CEQ
+    CNEIntInt,                // CNEIntInt, of CNE
+    CLTIntInt,                // CLTIntInt, of CLT
+    CLEIntInt,                // CLEIntInt, of CLE
+    AddFloatFloat,            // AddFloatFloat, of Add
+    SubFloatFloat,            // SubFloatFloat, of Sub
+    MulFloatFloat,            // MulFloatFloat, of Mul
+    DivFloatFloat,            // DivFloatFloat, of Div
+    CLTFloatFloat,            // CLTFloatFloat, of CLT
+    CLEFloatFloat,            // CLEFloatFloat, of CLE
+    CEQIntIntJumpIfNot,       // CEQIntIntJumpIfNot, of CEQJumpIfNot
+    CNEIntIntJumpIfNot,       // CNEIntIntJumpIfNot, of CNEJumpIfNot
+    CLTIntIntJumpIfNot,       // CLTIntIntJumpIfNot, of CLTJumpIfNot
+    CLEIntIntJumpIfNot,       // CLEIntIntJumpIfNot, of CLEJumpIfNot
+
+    /**
+     * loads by names are quickened at their first executions
+     *  if names are never defined but builtins,
+     *  or only defined once at the top level,
+     *  see Scope::definitions for when they are rewritten back
+    */
+    LoadBuiltin,              // LoadBuiltin name, of Load name
+    LoadGlobal,               // LoadGlobal name, of Load name
 };
 
+// the generic opcode of the quickened one, or the opcode itself
+inline constexpr Opcode generic_opcode(Opcode opcode) noexcept
+{
+    switch (opcode)
+    {
+    case Opcode::AddIntInt:
+    case Opcode::AddFloatFloat:
+        return Opcode::Add;
+    case Opcode::SubIntInt:
+    case Opcode::SubFloatFloat:
+        return Opcode::Sub;
+    case Opcode::MulIntInt:
+    case Opcode::MulFloatFloat:
+        return Opcode::Mul;
+    case Opcode::DivFloatFloat:
+        return Opcode::Div;
+    case Opcode::CEQIntInt:
+        return Opcode::CEQ;
+    case Opcode::CNEIntInt:
+        return Opcode::CNE;
+    case Opcode::CLTIntInt:
+    case Opcode::CLTFloatFloat:
+        return Opcode::CLT;
+    case Opcode::CLEIntInt:
+    case Opcode::CLEFloatFloat:
+        return Opcode::CLE;
+    case Opcode::CEQIntIntJumpIfNot:
+        return Opcode::CEQJumpIfNot;
+    case Opcode::CNEIntIntJumpIfNot:
+        return Opcode::CNEJumpIfNot;
+    case Opcode::CLTIntIntJumpIfNot:
+        return Opcode::CLTJumpIfNot;
+    case Opcode::CLEIntIntJumpIfNot:
+        return Opcode::CLEJumpIfNot;
+    case Opcode::LoadBuiltin:
+    case Opcode::LoadGlobal:
+        return Opcode::Load;
+
+    default:
+        return opcode;
+    }
+}
+
+/**
+ * each instruction is fixed-width,
+ *  an opcode with one inline integer oprand
+ *
+ * names are stored as indices into the name table of the code
+ *  and two-part oprands like (num, target) are packed
+ *  with the first part in the high 32 bits
+*/
+using Oprand = Size;
+
 struct Instruction
 {
     Opcode opcode;
-    std::any oprand;
+    Oprand oprand;
 };
+
+inline constexpr Oprand pack_oprand(Size first, Size second) noexcept
+{
+    return (first << 32) | (second & 0xFFFFFFFF);
+}
+
+inline constexpr std::pair<Size, Size> unpack_oprand(Oprand oprand) noexcept
+{
+    return { oprand >> 32, oprand & 0xFFFFFFFF };
+}
+
+/**
+ * oprands referencing variables keep the index of the name
+ *  in the low 32 bits, so that they can always be looked up by names
+ *
+ * slots resolved by the resolver are stored plus one in the next 16 bits,
+ *  zero means the variable has no slot,
+ *  and the depth of scopes to the slot is in the high 16 bits
+*/
+constexpr Size kMaxVariableSlot = 0xFFFE;
+constexpr Size kMaxVariableDepth = 0xFFFF;
+
+inline constexpr Oprand pack_variable(Size name, Size slot, Size depth = 0) noexcept
+{
+    return (depth << 48) | ((slot + 1) << 32) | (name & 0xFFFFFFFF);
+}
+
+inline constexpr Size variable_name(Oprand oprand) noexcept
+{
+    return oprand & 0xFFFFFFFF;
+}
+
+inline constexpr bool variable_has_slot(Oprand oprand) noexcept
+{
+    return (oprand >> 32) & 0xFFFF;
+}
+
+inline constexpr Size variable_slot(Oprand oprand) noexcept
+{
+    return ((oprand >> 32) & 0xFFFF) - 1;
+}
+
+inline constexpr Size variable_depth(Oprand oprand) noexcept
+{
+    return oprand >> 48;
+}
 }
 
 #endif
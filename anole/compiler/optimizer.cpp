@@ -0,0 +1,538 @@
+#include "compiler.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <optional>
+
+namespace anole
+{
+namespace
+{
+bool localEnabled = true;
+bool localWholeModule = false;
+
+void reduce(Ptr<Expr> &expr)
+{
+    if (expr)
+    {
+        expr->optimize();
+        if (auto folded = expr->fold())
+        {
+            expr = std::move(folded);
+        }
+    }
+}
+
+void reduce(ExprList &exprs)
+{
+    for (auto &expr : exprs)
+    {
+        reduce(expr);
+    }
+}
+
+void reduce(ArgumentList &args)
+{
+    for (auto &arg : args)
+    {
+        reduce(arg.first);
+    }
+}
+
+// the truth of the constant, or nothing if it's not constant
+std::optional<bool> truth(Expr *expr)
+{
+    // none has no truth, it throws when it's used as a condition
+    if (auto p = dynamic_cast<BoolExpr *>(expr))
+    {
+        return p->value;
+    }
+    else if (auto p = dynamic_cast<IntegerExpr *>(expr))
+    {
+        return p->value != 0;
+    }
+    else if (auto p = dynamic_cast<FloatExpr *>(expr))
+    {
+        return p->value != 0;
+    }
+    else if (auto p = dynamic_cast<StringExpr *>(expr))
+    {
+        return !p->value.empty();
+    }
+    else if (auto p = dynamic_cast<ListExpr *>(expr); p && p->constant)
+    {
+        return !p->exprs.empty();
+    }
+    else if (auto p = dynamic_cast<DictExpr *>(expr); p && p->constant)
+    {
+        return !p->keys.empty();
+    }
+    return std::nullopt;
+}
+
+Ptr<Expr> boolean(bool value)
+{
+    return std::make_unique<BoolExpr>(value);
+}
+
+// integers wrap around like they do at runtime
+Ptr<Expr> integer(uint64_t value)
+{
+    return std::make_unique<IntegerExpr>(int64_t(value));
+}
+
+Ptr<Expr> fold_integers(TokenType op, int64_t lhs, int64_t rhs)
+{
+    constexpr auto kMin = std::numeric_limits<int64_t>::min();
+
+    switch (op)
+    {
+    case TokenType::Add:
+        return integer(uint64_t(lhs) + uint64_t(rhs));
+    case TokenType::Sub:
+        return integer(uint64_t(lhs) - uint64_t(rhs));
+    case TokenType::Mul:
+        return integer(uint64_t(lhs) * uint64_t(rhs));
+    case TokenType::Div:
+        return rhs == 0 || (lhs == kMin && rhs == -1) ? nullptr : integer(lhs / rhs);
+    case TokenType::Mod:
+        return rhs == 0 || (lhs == kMin && rhs == -1) ? nullptr : integer(lhs % rhs);
+    case TokenType::BAnd:
+        return integer(lhs & rhs);
+    case TokenType::BOr:
+        return integer(lhs | rhs);
+    case TokenType::BXor:
+        return integer(lhs ^ rhs);
+    case TokenType::BLS:
+        return rhs < 0 || rhs >= 64 ? nullptr : integer(uint64_t(lhs) << rhs);
+    case TokenType::BRS:
+        return rhs < 0 || rhs >= 64 ? nullptr : integer(lhs >> rhs);
+    case TokenType::CEQ:
+        return boolean(lhs == rhs);
+    case TokenType::CNE:
+        return boolean(lhs != rhs);
+    case TokenType::CLT:
+        return boolean(lhs < rhs);
+    case TokenType::CLE:
+        return boolean(lhs <= rhs);
+    case TokenType::CGT:
+        return boolean(lhs > rhs);
+    case TokenType::CGE:
+        return boolean(lhs >= rhs);
+    default:
+        return nullptr;
+    }
+}
+
+Ptr<Expr> fold_floats(TokenType op, double lhs, double rhs)
+{
+    switch (op)
+    {
+    case TokenType::Add:
+        return std::make_unique<FloatExpr>(lhs + rhs);
+    case TokenType::Sub:
+        return std::make_unique<FloatExpr>(lhs - rhs);
+    case TokenType::Mul:
+        return std::make_unique<FloatExpr>(lhs * rhs);
+    case TokenType::Div:
+        return std::make_unique<FloatExpr>(lhs / rhs);
+    case TokenType::CEQ:
+        return boolean(lhs == rhs);
+    case TokenType::CNE:
+        return boolean(lhs != rhs);
+    case TokenType::CLT:
+        return boolean(lhs < rhs);
+    case TokenType::CLE:
+        return boolean(lhs <= rhs);
+    case TokenType::CGT:
+        return boolean(lhs > rhs);
+    case TokenType::CGE:
+        return boolean(lhs >= rhs);
+    default:
+        return nullptr;
+    }
+}
+
+Ptr<Expr> fold_strings(TokenType op, const String &lhs, const String &rhs)
+{
+    switch (op)
+    {
+    case TokenType::Add:
+        return std::make_unique<StringExpr>(lhs + rhs);
+    case TokenType::CEQ:
+        return boolean(lhs == rhs);
+    case TokenType::CNE:
+        return boolean(lhs != rhs);
+    default:
+        return nullptr;
+    }
+}
+
+// branches of ifs are not scopes, so they can be spliced into blocks
+Block::StmtList taken(IfElseStmt &stmt, bool cond)
+{
+    Block::StmtList statements;
+    if (cond)
+    {
+        statements.swap(stmt.true_block->statements);
+    }
+    else if (auto block = dynamic_cast<Block *>(stmt.false_branch.get()))
+    {
+        statements.swap(block->statements);
+    }
+    else if (stmt.false_branch)
+    {
+        statements.emplace_back(static_cast<IfElseStmt *>(stmt.false_branch.release()));
+    }
+    return statements;
+}
+
+bool jumps(Stmt *stmt)
+{
+    return dynamic_cast<ReturnStmt *>(stmt)
+        || dynamic_cast<BreakStmt *>(stmt)
+        || dynamic_cast<ContinueStmt *>(stmt)
+    ;
+}
+}
+
+void Optimizer::set_enabled(bool enabled)
+{
+    localEnabled = enabled;
+}
+
+bool Optimizer::enabled()
+{
+    return localEnabled;
+}
+
+void Optimizer::set_whole_module(bool whole_module)
+{
+    localWholeModule = whole_module;
+}
+
+bool Optimizer::whole_module()
+{
+    return localWholeModule;
+}
+
+/**
+ * statements of branches taken are spliced in place of their ifs
+ *  before they are optimized, so nested ones are pruned as well
+*/
+void Optimizer::optimize(Block::StmtList &statements)
+{
+    if (!localEnabled)
+    {
+        return;
+    }
+
+    for (auto it = statements.begin(); it != statements.end(); )
+    {
+        if (auto stmt = dynamic_cast<IfElseStmt *>(it->get()))
+        {
+            reduce(stmt->cond);
+            if (auto cond = truth(stmt->cond.get()))
+            {
+                auto branch = taken(*stmt, *cond);
+                auto next = statements.erase(it);
+                it = branch.empty() ? next : branch.begin();
+                statements.splice(next, branch);
+                continue;
+            }
+        }
+
+        (*it)->optimize();
+        if (auto stmt = dynamic_cast<WhileStmt *>(it->get()))
+        {
+            if (truth(stmt->cond.get()) == false)
+            {
+                it = statements.erase(it);
+                continue;
+            }
+        }
+        else if (jumps(it->get()))
+        {
+            statements.erase(std::next(it), statements.end());
+            break;
+        }
+        ++it;
+    }
+}
+
+void AST::optimize()
+{
+    // ...
+}
+
+Ptr<Expr> Expr::fold()
+{
+    return nullptr;
+}
+
+void Block::optimize()
+{
+    Optimizer::optimize(statements);
+}
+
+void ParenOperatorExpr::optimize()
+{
+    reduce(expr);
+    reduce(args);
+}
+
+void UnaryOperatorExpr::optimize()
+{
+    reduce(expr);
+}
+
+Ptr<Expr> UnaryOperatorExpr::fold()
+{
+    switch (op.type)
+    {
+    case TokenType::Sub:
+        if (auto p = dynamic_cast<IntegerExpr *>(expr.get()))
+        {
+            return integer(0 - uint64_t(p->value));
+        }
+        else if (auto p = dynamic_cast<FloatExpr *>(expr.get()))
+        {
+            return std::make_unique<FloatExpr>(-p->value);
+        }
+        break;
+
+    case TokenType::BNeg:
+        if (auto p = dynamic_cast<IntegerExpr *>(expr.get()))
+        {
+            return integer(~p->value);
+        }
+        break;
+
+    case TokenType::Not:
+        if (auto cond = truth(expr.get()))
+        {
+            return boolean(!*cond);
+        }
+        break;
+
+    default:
+        break;
+    }
+    return nullptr;
+}
+
+void BinaryOperatorExpr::optimize()
+{
+    reduce(lhs);
+    reduce(rhs);
+}
+
+/**
+ * `and` and `or` are folded if the left is enough to decide them,
+ *  and the right is not evaluated then
+*/
+Ptr<Expr> BinaryOperatorExpr::fold()
+{
+    if (op.type == TokenType::And || op.type == TokenType::Or)
+    {
+        auto left = truth(lhs.get());
+        if (!left)
+        {
+            return nullptr;
+        }
+        if (*left == (op.type == TokenType::Or))
+        {
+            return boolean(*left);
+        }
+        auto right = truth(rhs.get());
+        return right ? boolean(*right) : nullptr;
+    }
+
+    if (auto l = dynamic_cast<IntegerExpr *>(lhs.get()))
+    {
+        if (auto r = dynamic_cast<IntegerExpr *>(rhs.get()))
+        {
+            return fold_integers(op.type, l->value, r->value);
+        }
+    }
+    else if (auto l = dynamic_cast<FloatExpr *>(lhs.get()))
+    {
+        if (auto r = dynamic_cast<FloatExpr *>(rhs.get()))
+        {
+            return fold_floats(op.type, l->value, r->value);
+        }
+    }
+    else if (auto l = dynamic_cast<StringExpr *>(lhs.get()))
+    {
+        if (auto r = dynamic_cast<StringExpr *>(rhs.get()))
+        {
+            return fold_strings(op.type, l->value, r->value);
+        }
+    }
+    return nullptr;
+}
+
+void LambdaExpr::optimize()
+{
+    for (auto &parameter : parameters)
+    {
+        parameter.first->optimize();
+    }
+    block->optimize();
+}
+
+void DotExpr::optimize()
+{
+    reduce(left);
+}
+
+void EnumExpr::optimize()
+{
+    for (auto &decl : decls)
+    {
+        decl.optimize();
+    }
+}
+
+void MatchExpr::optimize()
+{
+    reduce(expr);
+    for (auto &keylist : keylists)
+    {
+        reduce(keylist);
+    }
+    for (auto &value : values)
+    {
+        reduce(value);
+    }
+    reduce(else_expr);
+}
+
+void ListExpr::optimize()
+{
+    reduce(exprs);
+    constant = !exprs.empty() && std::all_of(exprs.begin(), exprs.end(),
+        [](auto &expr) { return expr->is_constant(); }
+    );
+}
+
+void IndexExpr::optimize()
+{
+    reduce(expr);
+    reduce(index);
+}
+
+// keys of constant dicts can't be lists or dicts, which are copied
+void DictExpr::optimize()
+{
+    reduce(keys);
+    reduce(values);
+    constant = !keys.empty()
+        && std::all_of(keys.begin(), keys.end(), [](auto &key)
+            {
+                return truth(key.get()) && !dynamic_cast<ListExpr *>(key.get())
+                    && !dynamic_cast<DictExpr *>(key.get());
+            }
+        )
+        && std::all_of(values.begin(), values.end(),
+            [](auto &value) { return value->is_constant(); }
+        )
+    ;
+}
+
+void ClassExpr::optimize()
+{
+    reduce(bases);
+    for (auto &member : members)
+    {
+        member->optimize();
+    }
+}
+
+void DelayExpr::optimize()
+{
+    reduce(expr);
+}
+
+void QuesExpr::optimize()
+{
+    reduce(cond);
+    reduce(true_expr);
+    reduce(false_expr);
+}
+
+Ptr<Expr> QuesExpr::fold()
+{
+    if (auto taken = truth(cond.get()))
+    {
+        return std::move(*taken ? true_expr : false_expr);
+    }
+    return nullptr;
+}
+
+void ExprStmt::optimize()
+{
+    reduce(expr);
+}
+
+void NormalDeclarationStmt::optimize()
+{
+    reduce(expr);
+}
+
+void MultiVarsDeclarationStmt::optimize()
+{
+    reduce(exprs);
+}
+
+void ReturnStmt::optimize()
+{
+    reduce(exprs);
+}
+
+// elifs of constant conditions are replaced by branches taken
+void IfElseStmt::optimize()
+{
+    reduce(cond);
+    true_block->optimize();
+    while (auto elif = dynamic_cast<IfElseStmt *>(false_branch.get()))
+    {
+        reduce(elif->cond);
+        auto taken = truth(elif->cond.get());
+        if (!taken)
+        {
+            break;
+        }
+        false_branch = *taken
+            ? Ptr<AST>(std::move(elif->true_block))
+            : std::move(elif->false_branch)
+        ;
+    }
+    if (false_branch)
+    {
+        false_branch->optimize();
+    }
+}
+
+void WhileStmt::optimize()
+{
+    reduce(cond);
+    if (truth(cond.get()) == true)
+    {
+        cond = nullptr;
+    }
+    block->optimize();
+}
+
+void DoWhileStmt::optimize()
+{
+    block->optimize();
+    reduce(cond);
+}
+
+void ForeachStmt::optimize()
+{
+    reduce(expr);
+    block->optimize();
+}
+}
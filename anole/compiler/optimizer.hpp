@@ -0,0 +1,39 @@
+#ifndef __ANOLE_COMPILER_OPTIMIZER_HPP__
+#define __ANOLE_COMPILER_OPTIMIZER_HPP__
+
+#include "ast.hpp"
+
+namespace anole
+{
+/**
+ * the optimizer rewrites statements before codegen,
+ *  operations of constants are folded, branches and loops
+ *  of constant conditions are pruned, statements after
+ *  returns, breaks and continues are dropped, and lists and dicts
+ *  of constants are built once as constants, see CopyConst
+ *
+ * operations which would throw are left to run, like division by zero
+ *
+ * it can be disabled to see original instructions in dumps
+*/
+class Optimizer
+{
+  public:
+    static void set_enabled(bool enabled);
+    static bool enabled();
+
+    /**
+     * modules are compiled and run statement by statement by default,
+     *  in whole modules statements are all compiled before they run,
+     *  except that ones before declarations of operators run first,
+     *  for operators are added to the parser by running declarations
+    */
+    static void set_whole_module(bool whole_module);
+    static bool whole_module();
+
+    // statements may be removed or replaced by ones of their branches
+    static void optimize(Block::StmtList &statements);
+};
+}
+
+#endif
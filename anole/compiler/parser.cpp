@@ -723,79 +723,9 @@ Ptr<Expr> Parser::gen_expr(int layer)
         get_next_token();
         // gen_expr(layer) if right-associative
         auto rhs = gen_expr(layer + 1);
-        if (lhs->is_integer_expr() && rhs->is_integer_expr())
-        {
-            auto alias = reinterpret_cast<IntegerExpr *>(lhs.get());
-            auto rv = reinterpret_cast<IntegerExpr *>(rhs.get())->value;
-            switch (op.type)
-            {
-            case TokenType::Add:
-                alias->value += rv;
-                break;
-
-            case TokenType::Sub:
-                alias->value -= rv;
-                break;
-
-            case TokenType::Mul:
-                alias->value *= rv;
-                break;
-
-            case TokenType::Div:
-                alias->value /= rv;
-                break;
-
-            case TokenType::Mod:
-                alias->value %= rv;
-                break;
-
-            case TokenType::And:
-                lhs = std::make_unique<BoolExpr>(alias->value && rv);
-                break;
-
-            case TokenType::Or:
-                lhs = std::make_unique<BoolExpr>(alias->value || rv);
-                break;
-
-            case TokenType::Is:
-                lhs = std::make_unique<BoolExpr>(alias->value == rv);
-                break;
-
-            case TokenType::CEQ:
-                lhs = std::make_unique<BoolExpr>(alias->value == rv);
-                break;
-
-            case TokenType::CNE:
-                lhs = std::make_unique<BoolExpr>(alias->value != rv);
-                break;
-
-            case TokenType::CLT:
-                lhs = std::make_unique<BoolExpr>(alias->value < rv);
-                break;
-
-            case TokenType::CLE:
-                lhs = std::make_unique<BoolExpr>(alias->value <= rv);
-                break;
-
-            case TokenType::CGT:
-                lhs = std::make_unique<BoolExpr>(alias->value > rv);
-                break;
-
-            case TokenType::CGE:
-                lhs = std::make_unique<BoolExpr>(alias->value >= rv);
-                break;
-
-            default:
-                lhs = std::make_unique<BinaryOperatorExpr>(std::move(lhs), op, std::move(rhs));
-                break;
-            }
-        }
-        else
-        {
-            auto expr = std::make_unique<BinaryOperatorExpr>(std::move(lhs), op, std::move(rhs));
-            expr->location = location;
-            lhs = std::move(expr);
-        }
+        auto expr = std::make_unique<BinaryOperatorExpr>(std::move(lhs), op, std::move(rhs));
+        expr->location = location;
+        lhs = std::move(expr);
         // delete if right-associative
         op = current_token_;
     }
@@ -0,0 +1,147 @@
+#include "compiler.hpp"
+
+#include <initializer_list>
+
+namespace anole
+{
+namespace
+{
+bool localEnabled = true;
+
+// resolved loads are matched as Load, their handlers load in any way
+Opcode normalize(Opcode opcode)
+{
+    switch (opcode)
+    {
+    case Opcode::LoadLocal:
+    case Opcode::LoadUpvalue:
+        return Opcode::Load;
+
+    default:
+        return opcode;
+    }
+}
+
+/**
+ * check the sequence from the index matches the opcodes
+ *  and it must be complete in the code
+*/
+bool matches(const std::vector<Instruction> &instructions,
+    Size ind, std::initializer_list<Opcode> opcodes)
+{
+    if (ind + opcodes.size() > instructions.size())
+    {
+        return false;
+    }
+
+    for (auto opcode : opcodes)
+    {
+        if (normalize(instructions[ind++].opcode) != opcode)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool pops_one(const Instruction &ins)
+{
+    return ins.opcode == Opcode::Pop && ins.oprand == 1;
+}
+}
+
+void Peephole::set_enabled(bool enabled)
+{
+    localEnabled = enabled;
+}
+
+bool Peephole::enabled()
+{
+    return localEnabled;
+}
+
+void Peephole::optimize(Code &code, Size from)
+{
+    if (!localEnabled)
+    {
+        return;
+    }
+
+    auto &instructions = code.instructions_;
+    for (Size i = from; i < instructions.size(); ++i)
+    {
+        auto &ins = instructions[i];
+        switch (ins.opcode)
+        {
+        case Opcode::Load:
+        case Opcode::LoadLocal:
+        case Opcode::LoadUpvalue:
+            if (matches(instructions, i, { Opcode::Load, Opcode::Load, Opcode::Add }))
+            {
+                ins.opcode = Opcode::LoadLoadAdd;
+            }
+            else if (matches(instructions, i, { Opcode::Load, Opcode::LoadConst, Opcode::Add }))
+            {
+                ins.opcode = Opcode::LoadConstAdd;
+            }
+            else if (matches(instructions, i, { Opcode::Load, Opcode::LoadConst, Opcode::Sub }))
+            {
+                ins.opcode = Opcode::LoadConstSub;
+            }
+            else if (matches(instructions, i, { Opcode::Load, Opcode::Store, Opcode::Pop })
+                && pops_one(instructions[i + 2]))
+            {
+                ins.opcode = Opcode::LoadStorePop;
+            }
+            break;
+
+        case Opcode::Store:
+            if (matches(instructions, i, { Opcode::Store, Opcode::Pop })
+                && pops_one(instructions[i + 1]))
+            {
+                ins.opcode = Opcode::StorePop;
+            }
+            break;
+
+        case Opcode::CEQ:
+            if (matches(instructions, i, { Opcode::CEQ, Opcode::JumpIfNot }))
+            {
+                ins.opcode = Opcode::CEQJumpIfNot;
+            }
+            break;
+
+        case Opcode::CNE:
+            if (matches(instructions, i, { Opcode::CNE, Opcode::JumpIfNot }))
+            {
+                ins.opcode = Opcode::CNEJumpIfNot;
+            }
+            break;
+
+        case Opcode::CLT:
+            if (matches(instructions, i, { Opcode::CLT, Opcode::JumpIfNot }))
+            {
+                ins.opcode = Opcode::CLTJumpIfNot;
+            }
+            break;
+
+        case Opcode::CLE:
+            if (matches(instructions, i, { Opcode::CLE, Opcode::JumpIfNot }))
+            {
+                ins.opcode = Opcode::CLEJumpIfNot;
+            }
+            break;
+
+        case Opcode::LoadMember:
+            if (matches(instructions, i, { Opcode::LoadMember, Opcode::FastCall })
+                || matches(instructions, i, { Opcode::LoadMember, Opcode::FastTailCall }))
+            {
+                ins.opcode = Opcode::CallMethod;
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+}
+}
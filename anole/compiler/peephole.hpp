@@ -0,0 +1,26 @@
+#ifndef __ANOLE_COMPILER_PEEPHOLE_HPP__
+#define __ANOLE_COMPILER_PEEPHOLE_HPP__
+
+#include "code.hpp"
+
+namespace anole
+{
+/**
+ * the peephole pass rewrites heads of common sequences
+ *  to superinstructions after codegen,
+ *  see the superinstructions in instruction.hpp
+ *
+ * it can be disabled to see original instructions in dumps
+*/
+class Peephole
+{
+  public:
+    static void set_enabled(bool enabled);
+    static bool enabled();
+
+    // only instructions from the given index will be rewritten
+    static void optimize(Code &code, Size from = 0);
+};
+}
+
+#endif
@@ -0,0 +1,178 @@
+#include "compiler.hpp"
+
+namespace anole
+{
+namespace
+{
+/**
+ * levels of scopes from the body of a frame to its parent,
+ *  functions and thunks have a scope of their own
+ *  and another new scope for each call,
+ *  classes and enums only have one scope
+*/
+constexpr Size kCallDepth = 2;
+constexpr Size kBodyDepth = 1;
+
+struct Frame
+{
+    Frame *parent;
+    Size depth;
+    bool &dynamic;
+    std::map<Atom, Size> &slots;
+};
+
+Size closing(const std::vector<Instruction> &instructions,
+    Size ind, Opcode open, Opcode close)
+{
+    Size nested = 0;
+    for (++ind; ind < instructions.size(); ++ind)
+    {
+        auto opcode = instructions[ind].opcode;
+        if (opcode == open)
+        {
+            ++nested;
+        }
+        else if (opcode == close && nested-- == 0)
+        {
+            break;
+        }
+    }
+    return ind;
+}
+
+/**
+ * the end of the body of the frame beginning at the index,
+ *  or the index itself if there is no frame
+*/
+Size frame_end(const std::vector<Instruction> &instructions, Size ind)
+{
+    const auto &ins = instructions[ind];
+    switch (ins.opcode)
+    {
+    case Opcode::LambdaDecl:
+        return unpack_oprand(ins.oprand).second;
+    case Opcode::ThunkDecl:
+        return ins.oprand;
+    case Opcode::BuildClass:
+        return closing(instructions, ind, Opcode::BuildClass, Opcode::EndScope);
+    case Opcode::NewScope:
+        return closing(instructions, ind, Opcode::NewScope, Opcode::BuildEnum);
+
+    default:
+        return ind;
+    }
+}
+
+// the next instruction in the same frame
+Size next_of(const std::vector<Instruction> &instructions, Size ind)
+{
+    auto end = frame_end(instructions, ind);
+    return end == ind ? ind + 1 : end;
+}
+
+bool lookup(Frame *frame, Atom name, Size &depth, Size &slot)
+{
+    for (depth = 0; frame && !frame->dynamic; frame = frame->parent)
+    {
+        auto find = frame->slots.find(name);
+        if (find != frame->slots.end())
+        {
+            slot = find->second;
+            return slot <= kMaxVariableSlot && depth <= kMaxVariableDepth;
+        }
+        depth += frame->depth;
+    }
+    return false;
+}
+
+void resolve_frame(const Code &code, std::vector<Instruction> &instructions,
+    Frame &frame, Size begin, Size end)
+{
+    static const auto eval = Atoms::intern("eval");
+
+    // variables declared after their uses are also in slots
+    for (auto i = begin; i < end; i = next_of(instructions, i))
+    {
+        const auto &ins = instructions[i];
+        switch (ins.opcode)
+        {
+        case Opcode::StoreRef:
+        case Opcode::StoreLocal:
+            frame.slots.emplace(code.atom_at(ins.oprand), frame.slots.size());
+            break;
+
+        case Opcode::ImportAll:
+            frame.dynamic = true;
+            break;
+
+        case Opcode::Load:
+            if (code.atom_at(ins.oprand) == eval)
+            {
+                frame.dynamic = true;
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    for (auto i = begin; i < end; i = next_of(instructions, i))
+    {
+        auto &ins = instructions[i];
+        switch (ins.opcode)
+        {
+        case Opcode::LambdaDecl:
+        case Opcode::ThunkDecl:
+        case Opcode::BuildClass:
+        case Opcode::NewScope:
+        {
+            auto is_call = ins.opcode == Opcode::LambdaDecl
+                || ins.opcode == Opcode::ThunkDecl;
+            bool dynamic = !is_call;
+            std::map<Atom, Size> slots;
+            Frame child { &frame, is_call ? kCallDepth : kBodyDepth, dynamic, slots };
+            resolve_frame(code, instructions, child, i + 1, frame_end(instructions, i));
+        }
+            break;
+
+        case Opcode::Load:
+        {
+            Size depth, slot;
+            if (lookup(&frame, code.atom_at(ins.oprand), depth, slot))
+            {
+                ins = {
+                    depth ? Opcode::LoadUpvalue : Opcode::LoadLocal,
+                    pack_variable(ins.oprand, slot, depth)
+                };
+            }
+        }
+            break;
+
+        case Opcode::StoreRef:
+        case Opcode::StoreLocal:
+        {
+            auto slot = frame.slots.at(code.atom_at(ins.oprand));
+            if (!frame.dynamic && slot <= kMaxVariableSlot)
+            {
+                ins = {
+                    ins.opcode == Opcode::StoreRef ? Opcode::StoreRefSlot : Opcode::StoreSlot,
+                    pack_variable(ins.oprand, slot)
+                };
+            }
+        }
+            break;
+
+        default:
+            break;
+        }
+    }
+}
+}
+
+void Resolver::resolve(Code &code, Size from)
+{
+    Frame top { nullptr, 0, code.top_dynamic_, code.top_slots_ };
+    resolve_frame(code, code.instructions_, top, from, code.instructions_.size());
+}
+}
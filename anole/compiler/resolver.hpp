@@ -0,0 +1,26 @@
+#ifndef __ANOLE_COMPILER_RESOLVER_HPP__
+#define __ANOLE_COMPILER_RESOLVER_HPP__
+
+#include "code.hpp"
+
+namespace anole
+{
+/**
+ * the resolver resolves variables declared in functions, thunks
+ *  and the top level to slots of their scopes after codegen,
+ *  Load, StoreLocal and StoreRef of them are rewritten to
+ *  LoadLocal, LoadUpvalue, StoreSlot and StoreRefSlot
+ *
+ * bodies of classes and enums, and frames which import all
+ *  or refer to eval are dynamic, variables there or through them
+ *  are still looked up by names
+*/
+class Resolver
+{
+  public:
+    // only instructions from the given index will be rewritten
+    static void resolve(Code &code, Size from = 0);
+};
+}
+
+#endif
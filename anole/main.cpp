@@ -31,6 +31,57 @@ bool ends_with(const string_view &str,
 
     return true;
 }
+
+Argument::ActionType to_size = [](const String &value) -> any
+{
+    return Size(stoull(value));
+};
+
+Argument::ActionType to_double = [](const String &value) -> any
+{
+    return stod(value);
+};
+
+// print collections and the pause distribution of them for --gc-stats
+void print_pause_stats()
+{
+    auto &stats = Collector::pause_stats();
+    if (stats.count == 0)
+    {
+        return;
+    }
+
+    auto heap = Collector::heap_stats();
+    fprintf(stderr, "gc: %llu minor and %llu major collections, %llu bytes live\n",
+        static_cast<unsigned long long>(heap.minors),
+        static_cast<unsigned long long>(heap.majors),
+        static_cast<unsigned long long>(heap.live)
+    );
+
+    fprintf(stderr, "gc: %llu pauses, %.3f ms in total, %.3f ms at most\n",
+        static_cast<unsigned long long>(stats.count),
+        stats.total / 1e6, stats.max / 1e6
+    );
+    for (Size i = 0; i < Collector::PauseStats::kBuckets; ++i)
+    {
+        if (stats.buckets[i] == 0)
+        {
+            continue;
+        }
+        if (i + 1 < Collector::PauseStats::kBuckets)
+        {
+            fprintf(stderr, "  < %llu us: %llu\n",
+                1ULL << i, static_cast<unsigned long long>(stats.buckets[i])
+            );
+        }
+        else
+        {
+            fprintf(stderr, "  longer: %llu\n",
+                static_cast<unsigned long long>(stats.buckets[i])
+            );
+        }
+    }
+}
 }
 
 int main(int argc, char *argv[]) try
@@ -43,7 +94,11 @@ int main(int argc, char *argv[]) try
     {
         /**
          * find where the first anole file is
-         *  anole [-r] (file) [arg1[ arg2[ ...]]]
+         *  anole [-r] [--no-optimize] [--whole-module] [--no-peephole] [--no-generational]
+         *    [--jit] [--jit-threshold n] [--aot]
+         *    [--gc-budget work] [--gc-pause us] [--gc-threads n]
+         *    [--gc-growth factor] [--gc-limit bytes] [--gc-compact] [--gc-stats]
+         *    (file) [arg1[ arg2[ ...]]]
          *
          * just find it by the extension ".anole"
         */
@@ -62,6 +117,62 @@ int main(int argc, char *argv[]) try
               .default_value(false)
               .implict_value(true)
         ;
+        parser.add_argument("--no-optimize")
+              .default_value(false)
+              .implict_value(true)
+        ;
+        parser.add_argument("--whole-module")
+              .default_value(false)
+              .implict_value(true)
+        ;
+        parser.add_argument("--no-peephole")
+              .default_value(false)
+              .implict_value(true)
+        ;
+        parser.add_argument("--jit")
+              .default_value(false)
+              .implict_value(true)
+        ;
+        parser.add_argument("--jit-threshold")
+              .default_value(Size(Jit::kDefaultThreshold))
+              .action(to_size)
+        ;
+        parser.add_argument("--aot")
+              .default_value(false)
+              .implict_value(true)
+        ;
+        parser.add_argument("--no-generational")
+              .default_value(false)
+              .implict_value(true)
+        ;
+        parser.add_argument("--gc-budget")
+              .default_value(Size(10000))
+              .action(to_size)
+        ;
+        parser.add_argument("--gc-pause")
+              .default_value(Size(0))
+              .action(to_size)
+        ;
+        parser.add_argument("--gc-threads")
+              .default_value(Size(0))
+              .action(to_size)
+        ;
+        parser.add_argument("--gc-growth")
+              .default_value(2.0)
+              .action(to_double)
+        ;
+        parser.add_argument("--gc-limit")
+              .default_value(Size(0))
+              .action(to_size)
+        ;
+        parser.add_argument("--gc-compact")
+              .default_value(false)
+              .implict_value(true)
+        ;
+        parser.add_argument("--gc-stats")
+              .default_value(false)
+              .implict_value(true)
+        ;
         parser.add_argument("--version")
               .default_value(false)
               .implict_value(true)
@@ -74,6 +185,20 @@ int main(int argc, char *argv[]) try
             return 0;
         }
 
+        Optimizer::set_enabled(!parser.get<bool>("no-optimize"));
+        Optimizer::set_whole_module(parser.get<bool>("whole-module"));
+        Peephole::set_enabled(!parser.get<bool>("no-peephole"));
+        Jit::set_enabled(parser.get<bool>("jit"));
+        Jit::set_threshold(parser.get<Size>("jit-threshold"));
+        Collector::set_generational(!parser.get<bool>("no-generational"));
+        Collector::set_budget(
+            parser.get<Size>("gc-budget"), parser.get<Size>("gc-pause")
+        );
+        Collector::set_threads(parser.get<Size>("gc-threads"));
+        Collector::set_growth(parser.get<double>("gc-growth"));
+        Collector::set_limit(parser.get<Size>("gc-limit"));
+        Collector::set_compaction(parser.get<bool>("gc-compact"));
+
         Context::set_args(argc, argv, file_pos);
 
         auto path = fs::path(parser.get("file"));
@@ -102,19 +227,33 @@ int main(int argc, char *argv[]) try
             {
                 cout << "anole: cannot open file " << path << endl;
             }
-            else if (parser.get<bool>("r"))
+            else
             {
                 auto anole_mod = reinterpret_cast<AnoleModuleObject *>(mod);
 
-                auto rd_path = path;
-                rd_path += ".rd";
-                anole_mod->code()->print(rd_path);
+                if (parser.get<bool>("r"))
+                {
+                    auto rd_path = path;
+                    rd_path += ".rd";
+                    anole_mod->code()->print(rd_path);
+                }
+
+                // the module is compiled to path.so after it runs
+                if (parser.get<bool>("aot"))
+                {
+                    Aot::compile(*anole_mod->code(), path);
+                }
             }
         }
         catch (const exception& e)
         {
             cerr << e.what() << endl;
         }
+
+        if (parser.get<bool>("gc-stats"))
+        {
+            print_pause_stats();
+        }
     }
     return 0;
 }
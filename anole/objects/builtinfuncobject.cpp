@@ -3,27 +3,65 @@
 #include "../runtime/runtime.hpp"
 
 #include <map>
+#include <unordered_map>
 
 namespace anole
 {
 namespace
 {
-std::map<String, BuiltInFunctionObject *>
-&get_built_in_functions()
+// builtin functions indexed by atoms of their names
+std::vector<BuiltInFunctionObject *> &get_built_in_functions()
 {
-    static std::map<String, BuiltInFunctionObject *> built_in_functions;
+    static std::vector<BuiltInFunctionObject *> built_in_functions;
     return built_in_functions;
 }
+
+// tables of native methods indexed by types
+std::vector<const NativeMethods *> &get_native_methods()
+{
+    static std::vector<const NativeMethods *> native_methods;
+    return native_methods;
+}
 }
 
-Object
-*BuiltInFunctionObject::load_built_in_function(const String &name)
+const NativeMethod *NativeMethods::find(ObjectType type, Atom name)
 {
-    if (get_built_in_functions().count(name))
+    if (!has(type))
     {
-        return get_built_in_functions()[name];
+        return nullptr;
     }
-    return nullptr;
+
+    auto &methods = get_native_methods()[Size(type)]->methods_;
+    auto method = methods.find(name);
+    return method == methods.end() ? nullptr : &method->second;
+}
+
+bool NativeMethods::has(ObjectType type)
+{
+    auto &tables = get_native_methods();
+    return Size(type) < tables.size() && tables[Size(type)];
+}
+
+NativeMethods::NativeMethods(ObjectType type, std::map<String, NativeMethod> methods)
+{
+    for (auto &name_method : methods)
+    {
+        methods_.emplace(Atoms::intern(name_method.first), name_method.second);
+    }
+
+    auto &tables = get_native_methods();
+    if (Size(type) >= tables.size())
+    {
+        tables.resize(Size(type) + 1);
+    }
+    tables[Size(type)] = this;
+}
+
+Object
+*BuiltInFunctionObject::load_built_in_function(Atom name)
+{
+    auto &functions = get_built_in_functions();
+    return name < functions.size() ? functions[name] : nullptr;
 }
 
 void BuiltInFunctionObject::register_built_in_function(
@@ -33,7 +71,13 @@ void BuiltInFunctionObject::register_built_in_function(
      * builtin functions won't be marked
      *  and always live until the program exits
     */
-    get_built_in_functions()[name] = new BuiltInFunctionObject(func);
+    auto atom = Atoms::intern(name);
+    auto &functions = get_built_in_functions();
+    if (atom >= functions.size())
+    {
+        functions.resize(atom + 1);
+    }
+    functions[atom] = new BuiltInFunctionObject(func);
 }
 
 BuiltInFunctionObject::BuiltInFunctionObject(std::function<void(Size)> func, Object *bind) noexcept
@@ -53,8 +97,13 @@ void BuiltInFunctionObject::call(Size n)
     ++theCurrContext->pc();
 }
 
-void BuiltInFunctionObject::collect(std::function<void(Object *)> func)
+void BuiltInFunctionObject::trace(Visitor &visitor)
+{
+    visitor.visit_place(bind_);
+}
+
+Object *BuiltInFunctionObject::relocate(void *cell)
 {
-    func(bind_);
+    return new (cell) BuiltInFunctionObject(std::move(*this));
 }
 }
@@ -3,7 +3,9 @@
 
 #include "object.hpp"
 
+#include <map>
 #include <vector>
+#include <unordered_map>
 #include <functional>
 
 #define REGISTER_BUILTIN(NAME, FUNC) \
@@ -17,10 +19,67 @@
 
 namespace anole
 {
+/**
+ * native methods of built-in types are plain functions
+ *  taking their receivers, which pop arguments and push results
+ *  like built-in functions
+*/
+class NativeMethod
+{
+  public:
+    template<typename T>
+    NativeMethod(void (*func)(T *)) noexcept
+      : func_(reinterpret_cast<Erased>(func))
+      , invoke_([](Erased func, Object *self)
+            {
+                reinterpret_cast<void (*)(T *)>(func)(static_cast<T *>(self));
+            }
+        )
+    {
+        // ...
+    }
+
+    // for lambdas without captures
+    template<typename F>
+    NativeMethod(F func) noexcept
+      : NativeMethod(+func)
+    {
+        // ...
+    }
+
+    void operator()(Object *self) const
+    {
+        invoke_(func_, self);
+    }
+
+  private:
+    using Erased = void (*)();
+
+    Erased func_;
+    void (*invoke_)(Erased, Object *);
+};
+
+/**
+ * each built-in type has one table of native methods,
+ *  tables are defined as globals and register themselves
+*/
+class NativeMethods
+{
+  public:
+    static const NativeMethod *find(ObjectType type, Atom name);
+    static bool has(ObjectType type);
+
+  public:
+    NativeMethods(ObjectType type, std::map<String, NativeMethod> methods);
+
+  private:
+    std::unordered_map<Atom, NativeMethod> methods_;
+};
+
 class BuiltInFunctionObject : public Object
 {
   public:
-    static Object *load_built_in_function(const String &);
+    static Object *load_built_in_function(Atom name);
     static void register_built_in_function(const String &, std::function<void(Size)>);
 
   public:
@@ -30,7 +89,8 @@ class BuiltInFunctionObject : public Object
     String to_str() override;
     void call(Size num) override;
 
-    void collect(std::function<void(Object *)>) override;
+    void trace(Visitor &visitor) override;
+    Object *relocate(void *cell) override;
 
   private:
     std::function<void(Size)> func_;
@@ -15,12 +15,21 @@ SPtr<Scope> &ClassObject::scope()
     return scope_;
 }
 
-Address ClassObject::load_member(const String &name)
+Address ClassObject::load_member(Atom name)
 {
-    if (scope_->symbols().count(name))
-    {
-        auto member = scope_->load_symbol(name);
+    return bind_member(scope_->find_local(name), name);
+}
+
+Address ClassObject::load_cached_member(Atom name, MemberCache &cache)
+{
+    return bind_member(scope_->find_local(name, &cache), name);
+}
 
+// callable members are bound to the class as methods
+Address ClassObject::bind_member(Address member, Atom name)
+{
+    if (member)
+    {
         if (member->ptr()->is_callable())
         {
             return std::make_shared<Variable>(
@@ -41,14 +50,11 @@ Address ClassObject::load_member(const String &name)
 */
 void ClassObject::call(Size num)
 {
-    auto instance = Allocator<Object>::alloc<InstanceObject>();
+    auto instance = Allocator<Object>::alloc<InstanceObject>(this);
 
-    for (auto &sym_addr : scope_->symbols())
-    {
-        instance->scope()->create_symbol(sym_addr.first, sym_addr.second->ptr());
-    }
-
-    if (scope_->symbols().count("__init__"))
+    static const auto init = Atoms::intern("__init__");
+    auto ctor = scope_->find_local(init);
+    if (ctor)
     {
         /**
          * __init__ is a special method to construct object
@@ -57,11 +63,11 @@ void ClassObject::call(Size num)
          * this is be done in the parse phase
         */
         theCurrContext->push(instance);
-        auto ctor = scope_->load_symbol("__init__");
         ctor->ptr()->call(num + 1);
     }
     else if (num == 0)
     {
+        theCurrContext->push(instance);
         ++theCurrContext->pc();
     }
     else
@@ -70,8 +76,8 @@ void ClassObject::call(Size num)
     }
 }
 
-void ClassObject::collect(std::function<void(Scope *)> func)
+void ClassObject::trace(Visitor &visitor)
 {
-    func(scope_.get());
+    visitor.visit(scope_);
 }
 } // namespace anole
@@ -15,10 +15,14 @@ class ClassObject : public Object
     SPtr<Scope> &scope();
 
   public:
-    Address load_member(const String &name) override;
+    Address load_member(Atom name) override;
+    Address load_cached_member(Atom name, MemberCache &cache) override;
     void call(Size num) override;
 
-    void collect(std::function<void(Scope *)>) override;
+    void trace(Visitor &visitor) override;
+
+  private:
+    Address bind_member(Address member, Atom name);
 
   private:
     String name_;
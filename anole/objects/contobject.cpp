@@ -28,8 +28,8 @@ void ContObject::call(Size n)
     ++theCurrContext->pc();
 }
 
-void ContObject::collect(std::function<void(Context *)> func)
+void ContObject::trace(Visitor &visitor)
 {
-    func(resume_.get());
+    visitor.visit(resume_);
 }
 }
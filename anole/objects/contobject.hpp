@@ -15,7 +15,7 @@ class ContObject : public Object
   public:
     void call(Size num) override;
 
-    void collect(std::function<void(Context *)>) override;
+    void trace(Visitor &visitor) override;
 
   private:
     SPtr<Context> resume_;
@@ -6,42 +6,44 @@ namespace anole
 {
 namespace
 {
-std::map<String, std::function<void(DictObject *)>>
-localBuiltinMethods
+const NativeMethods localBuiltinMethods
 {
-    {"empty", [](DictObject *obj)
-        {
-            theCurrContext->push(obj->data().empty() ? BoolObject::the_true() : BoolObject::the_false());
-        }
-    },
-    {"size", [](DictObject *obj)
-        {
-            theCurrContext->push(Allocator<Object>::alloc<IntegerObject>(int64_t(obj->data().size())));
-        }
-    },
-    {"at", [](DictObject *obj)
-        {
-            theCurrContext->push(obj->index(theCurrContext->pop_ptr())->ptr());
-        }
-    },
-    {"insert", [](DictObject *obj)
-        {
-            auto p1 = theCurrContext->pop_ptr();
-            auto p2 = theCurrContext->pop_ptr();
-            obj->insert(p1, p2);
-            theCurrContext->push(NoneObject::one());
-        }
-    },
-    {"erase", [](DictObject *obj)
-        {
-            obj->data().erase(theCurrContext->pop_ptr());
-            theCurrContext->push(NoneObject::one());
-        }
-    },
-    {"clear", [](DictObject *obj)
-        {
-            obj->data().clear();
-            theCurrContext->push(NoneObject::one());
+    ObjectType::Dict,
+    {
+        {"empty", [](DictObject *obj)
+            {
+                theCurrContext->push(obj->data().empty() ? BoolObject::the_true() : BoolObject::the_false());
+            }
+        },
+        {"size", [](DictObject *obj)
+            {
+                theCurrContext->push(Value::integer(int64_t(obj->data().size())));
+            }
+        },
+        {"at", [](DictObject *obj)
+            {
+                theCurrContext->push(obj->index(theCurrContext->pop_ptr())->value());
+            }
+        },
+        {"insert", [](DictObject *obj)
+            {
+                auto p1 = theCurrContext->pop_ptr();
+                auto p2 = theCurrContext->pop_value();
+                obj->insert(p1, p2);
+                theCurrContext->push(NoneObject::one());
+            }
+        },
+        {"erase", [](DictObject *obj)
+            {
+                obj->data().erase(theCurrContext->pop_ptr());
+                theCurrContext->push(NoneObject::one());
+            }
+        },
+        {"clear", [](DictObject *obj)
+            {
+                obj->data().clear();
+                theCurrContext->push(NoneObject::one());
+            }
         }
     }
 };
@@ -63,9 +65,10 @@ DictObject::DataType &DictObject::data()
     return data_;
 }
 
-void DictObject::insert(Object *key, Object *value)
+void DictObject::insert(Object *key, Value value)
 {
-    data_[key] = std::make_shared<Variable>(value);
+    Collector::write_barrier(this, key);
+    data_[key] = std::make_shared<Variable>(value, this);
 }
 
 bool DictObject::to_bool()
@@ -83,7 +86,7 @@ String DictObject::to_str()
         {
             res += ",";
         }
-        res += " " + it->first->to_str() + " => " + it->second->ptr()->to_str();
+        res += " " + it->first->to_str() + " => " + it->second->value().to_str();
     }
     return res + " }";
 }
@@ -103,34 +106,46 @@ Address DictObject::index(Object *index)
     /**
      * dict will create an empty target if the key is not recorded
     */
-    return data_[index] = std::make_shared<Variable>();
+    Collector::write_barrier(this, index);
+    return data_[index] = std::make_shared<Variable>(Value(), this);
 }
 
-Address DictObject::load_member(const String &name)
+Address DictObject::load_member(Atom name)
 {
-    auto method = localBuiltinMethods.find(name);
-    if (method != localBuiltinMethods.end())
+    if (NativeMethods::find(ObjectType::Dict, name))
     {
-        return std::make_shared<Variable>(
-            Allocator<Object>::alloc<BuiltInFunctionObject>(
-                [this, &func = method->second]
-                (Size) mutable
-                {
-                    func(this);
-                },
-                this
-            )
-        );
+        return Object::load_member(name);
     }
-    return index(Allocator<Object>::alloc<StringObject>(name));
+    return index(Allocator<Object>::alloc<StringObject>(Atoms::name(name)));
 }
 
-void DictObject::collect(std::function<void(Object *)> func)
+/**
+ * keys can't be redirected in place for they are sorted,
+ *  the dict is sorted again by the visitor if any of them is moved
+*/
+void DictObject::trace(Visitor &visitor)
 {
+    auto moved = false;
     for (auto &key_addr : data_)
     {
-        func(key_addr.first);
-        func(key_addr.second->ptr());
+        auto key = key_addr.first;
+        visitor.visit_place(key);
+        moved = moved || key != key_addr.first;
+        visitor.visit(key_addr.second);
+    }
+    if (moved)
+    {
+        visitor.rekey(this);
+    }
+}
+
+Object *DictObject::relocate(void *cell)
+{
+    auto moved = new (cell) DictObject(std::move(*this));
+    for (auto &key_addr : moved->data_)
+    {
+        key_addr.second->relocate_owner(this, moved);
     }
+    return moved;
 }
 }
@@ -21,7 +21,7 @@ class DictObject : public Object
     DictObject() noexcept;
 
     DataType &data();
-    void insert(Object *key, Object *value);
+    void insert(Object *key, Value value);
 
   public:
     bool to_bool() override;
@@ -29,9 +29,10 @@ class DictObject : public Object
     String to_key() override;
 
     Address index(Object *) override;
-    Address load_member(const String &name) override;
+    Address load_member(Atom name) override;
 
-    void collect(std::function<void(Object *)>) override;
+    void trace(Visitor &visitor) override;
+    Object *relocate(void *cell) override;
 
   private:
     DataType data_;
@@ -16,17 +16,17 @@ SPtr<Scope> &EnumObject::scope()
     return scope_;
 }
 
-Address EnumObject::load_member(const String &name)
+Address EnumObject::load_member(Atom name)
 {
-    if (scope_->symbols().count(name))
+    if (auto member = scope_->find_local(name))
     {
-        return std::make_shared<Variable>(scope_->load_symbol(name)->ptr());
+        return std::make_shared<Variable>(member->value());
     }
     return Object::load_member(name);
 }
 
-void EnumObject::collect(std::function<void(Scope *)> func)
+void EnumObject::trace(Visitor &visitor)
 {
-    func(scope_.get());
+    visitor.visit(scope_);
 }
 }
@@ -15,9 +15,9 @@ class EnumObject : public Object
     SPtr<Scope> &scope();
 
   public:
-    Address load_member(const String &name) override;
+    Address load_member(Atom name) override;
 
-    void collect(std::function<void(Scope *)>) override;
+    void trace(Visitor &visitor) override;
 
   private:
     SPtr<Scope> scope_;
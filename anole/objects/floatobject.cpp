@@ -127,4 +127,9 @@ Object *FloatObject::cle(Object *obj)
         throw RuntimeError("no match method");
     }
 }
+
+Object *FloatObject::relocate(void *cell)
+{
+    return new (cell) FloatObject(std::move(*this));
+}
 }
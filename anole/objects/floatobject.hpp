@@ -33,6 +33,8 @@ class FloatObject : public Object
     Object *clt(Object *) override;
     Object *cle(Object *) override;
 
+    Object *relocate(void *cell) override;
+
   private:
     double value_;
 };
@@ -3,14 +3,27 @@
 #include "../runtime/runtime.hpp"
 #include "../compiler/compiler.hpp"
 
-#define OPRAND(T) std::any_cast<const T &>(theCurrContext->oprand())
+#define OPRAND(T) (theCurrContext->code()->oprand_at<T>(theCurrContext->pc()))
 
 namespace anole
 {
+namespace
+{
+// parameters resolved by the resolver are also kept in their slots
+void set_parameter_slot(const Address &addr)
+{
+    auto opcode = theCurrContext->opcode();
+    if (opcode == Opcode::StoreSlot || opcode == Opcode::StoreRefSlot)
+    {
+        theCurrContext->scope()->set_slot(variable_slot(OPRAND(Size)), addr);
+    }
+}
+}
+
 FunctionObject::FunctionObject(SPtr<Scope> pre_scope,
     SPtr<Code> code, Size base, Size parameter_num)
   : Object(ObjectType::Func)
-  , scope_(std::make_shared<Scope>(pre_scope))
+  , scope_(make_pooled<Scope>(pre_scope))
   , code_(code), base_(base)
   , parameter_num_(parameter_num)
 {
@@ -37,14 +50,19 @@ String FunctionObject::to_str()
     return "<function>";
 }
 
-Address FunctionObject::load_member(const String &name)
+Address FunctionObject::load_member(Atom name)
 {
     return scope_->load_symbol(name);
 }
 
 void FunctionObject::call(Size num)
 {
-    theCurrContext = std::make_shared<Context>(
+    if (Jit::enabled())
+    {
+        Jit::count_call(*code_, base_);
+    }
+
+    theCurrContext = make_pooled<Context>(
         theCurrContext, scope_, code_, base_
     );
 
@@ -59,11 +77,14 @@ void FunctionObject::call(Size num)
         {
             ++pc;
             auto list = Allocator<Object>::alloc<ListObject>();
-            if (theCurrContext->opcode() == Opcode::StoreRef)
+            if (theCurrContext->opcode() == Opcode::StoreRef
+                || theCurrContext->opcode() == Opcode::StoreRefSlot)
             {
                 while (arg_num)
                 {
-                    list->objects().push_back(theCurrContext->pop_address());
+                    auto addr = theCurrContext->pop_address();
+                    addr->release();
+                    list->objects().push_back(std::move(addr));
                     --arg_num;
                 }
             }
@@ -72,33 +93,37 @@ void FunctionObject::call(Size num)
             {
                 while (arg_num)
                 {
-                    list->append(theCurrContext->pop_ptr());
+                    list->append(theCurrContext->pop_value());
                     --arg_num;
                 }
             }
-            theCurrContext->scope()
-                ->create_symbol(OPRAND(String))
-                    ->bind(list)
-            ;
+            auto addr = theCurrContext->scope()->create_symbol(OPRAND(Atom));
+            addr->bind(list);
+            set_parameter_slot(addr);
         }
             ++pc;
             --parameter_num;
             break;
 
         case Opcode::StoreRef:
-            theCurrContext->scope()->create_symbol(OPRAND(String),
-                theCurrContext->pop_address()
-            );
+        case Opcode::StoreRefSlot:
+        {
+            auto addr = theCurrContext->pop_address();
+            theCurrContext->scope()->create_symbol(OPRAND(Atom), addr);
+            set_parameter_slot(addr);
+        }
             ++pc;
             --arg_num;
             --parameter_num;
             break;
 
         case Opcode::StoreLocal:
-            theCurrContext->scope()
-                ->create_symbol(OPRAND(String))
-                    ->bind(theCurrContext->pop_ptr())
-            ;
+        case Opcode::StoreSlot:
+        {
+            auto addr = theCurrContext->scope()->create_symbol(OPRAND(Atom));
+            addr->bind(theCurrContext->pop_value());
+            set_parameter_slot(addr);
+        }
             ++pc;
             --arg_num;
             --parameter_num;
@@ -134,13 +159,16 @@ void FunctionObject::call(Size num)
      *
      * we can check this because parameters without default value
      *  cannot follow parameters with default value,
-     *  so if the following instruction is StoreRef/StoreLocal
+     *  so if the following instruction is StoreRef/StoreLocal,
+     *  or StoreRefSlot/StoreSlot once it's resolved,
      *  means that the arguments is less than the function need
     */
     else if (parameter_num)
     {
         if (theCurrContext->opcode() == Opcode::StoreRef
-            || theCurrContext->opcode() == Opcode::StoreLocal)
+            || theCurrContext->opcode() == Opcode::StoreLocal
+            || theCurrContext->opcode() == Opcode::StoreRefSlot
+            || theCurrContext->opcode() == Opcode::StoreSlot)
         {
             throw RuntimeError("missing the parameter named '" + OPRAND(String) + '\'');
         }
@@ -152,8 +180,13 @@ bool FunctionObject::is_callable()
     return true;
 }
 
-void FunctionObject::collect(std::function<void(Scope *)> func)
+void FunctionObject::trace(Visitor &visitor)
+{
+    visitor.visit(scope_);
+}
+
+Object *FunctionObject::relocate(void *cell)
 {
-    func(scope_.get());
+    return new (cell) FunctionObject(std::move(*this));
 }
 }
@@ -18,11 +18,12 @@ class FunctionObject : public Object
 
   public:
     String to_str() override;
-    Address load_member(const String &name) override;
+    Address load_member(Atom name) override;
     void call(Size num) override;
     bool is_callable() override;
 
-    void collect(std::function<void(Scope *)>) override;
+    void trace(Visitor &visitor) override;
+    Object *relocate(void *cell) override;
 
   private:
     SPtr<Scope> scope_;
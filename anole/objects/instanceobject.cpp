@@ -4,41 +4,99 @@
 
 namespace anole
 {
-InstanceObject::InstanceObject()
+InstanceObject::InstanceObject(ClassObject *cls)
   : Object(ObjectType::Instance)
-  , scope_(std::make_shared<Scope>(nullptr))
+  , class_(cls), shape_(Shape::root())
 {
     // ...
 }
 
-SPtr<Scope> &InstanceObject::scope()
+Address InstanceObject::load_member(Atom name)
 {
-    return scope_;
+    auto index = shape_->find(name);
+    if (index != Shape::kNotFound)
+    {
+        return bind_member(fields_[index]);
+    }
+    return load_class_member(name, nullptr);
 }
 
-Address InstanceObject::load_member(const String &name)
+Address InstanceObject::load_cached_member(Atom name, MemberCache &cache)
 {
-    if (scope_->symbols().count(name))
+    Size index;
+    if (auto entry = cache.find(shape_->id()))
     {
-        auto member = scope_->load_symbol(name);
+        index = entry->index;
+    }
+    else
+    {
+        index = shape_->find(name);
+        cache.insert({ shape_->id(), nullptr, index });
+    }
 
-        if (member->ptr()->is_callable())
+    if (index != Shape::kNotFound)
+    {
+        return bind_member(fields_[index]);
+    }
+    return load_class_member(name, &cache);
+}
+
+void InstanceObject::trace(Visitor &visitor)
+{
+    visitor.visit_place(class_);
+    for (auto &field : fields_)
+    {
+        visitor.visit(field);
+    }
+}
+
+/**
+ * methods of the class are bound to the instance,
+ *  and other attributes are copied to fields when they are loaded,
+ *  so that changes of them only belong to the instance
+ *
+ * members not found will be new fields
+*/
+Address InstanceObject::load_class_member(Atom name, MemberCache *cache)
+{
+    auto member = class_->scope()->find_local(name, cache);
+    if (member)
+    {
+        auto obj = member->value().heap_object();
+        if (obj && obj->is_callable())
         {
-            return std::make_shared<Variable>(
-                Allocator<Object>::alloc<MethodObject>(member->ptr(), this)
-            );
+            return bind_member(member);
         }
-
-        return member;
     }
-    else
+
+    auto field = std::make_shared<Variable>(
+        member ? member->value() : Value(), this
+    );
+    shape_ = shape_->add(name);
+    fields_.push_back(field);
+    return field;
+}
+
+// callable members are bound to the instance as methods
+Address InstanceObject::bind_member(Address member)
+{
+    auto obj = member->value().heap_object();
+    if (obj && obj->is_callable())
     {
-        return scope_->create_symbol(name);
+        return std::make_shared<Variable>(
+            Allocator<Object>::alloc<MethodObject>(obj, this)
+        );
     }
+    return member;
 }
 
-void InstanceObject::collect(std::function<void(Scope *)> func)
+Object *InstanceObject::relocate(void *cell)
 {
-    func(scope_.get());
+    auto moved = new (cell) InstanceObject(std::move(*this));
+    for (auto &field : moved->fields_)
+    {
+        field->relocate_owner(this, moved);
+    }
+    return moved;
 }
 } // namespace anole
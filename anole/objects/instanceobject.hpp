@@ -3,22 +3,37 @@
 
 #include "object.hpp"
 
+#include <vector>
+
 namespace anole
 {
+class Shape;
+class ClassObject;
+
+/**
+ * instances only keep their own fields described by their shapes,
+ *  other members are found in their classes
+*/
 class InstanceObject : public Object
 {
   public:
-    InstanceObject();
-
-    SPtr<Scope> &scope();
+    InstanceObject(ClassObject *cls);
 
   public:
-    Address load_member(const String &name) override;
+    Address load_member(Atom name) override;
+    Address load_cached_member(Atom name, MemberCache &cache) override;
 
-    void collect(std::function<void(Scope *)>) override;
+    void trace(Visitor &visitor) override;
+    Object *relocate(void *cell) override;
+
+  private:
+    Address load_class_member(Atom name, MemberCache *cache);
+    Address bind_member(Address member);
 
   private:
-    SPtr<Scope> scope_;
+    ClassObject *class_;
+    Shape *shape_;
+    std::vector<Address> fields_;
 };
 } // namespace anole
 
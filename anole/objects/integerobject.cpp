@@ -4,6 +4,21 @@
 
 namespace anole
 {
+namespace
+{
+const NativeMethods localBuiltinMethods
+{
+    ObjectType::Integer,
+    {
+        {"to_str", [](IntegerObject *obj)
+            {
+                theCurrContext->push(Allocator<Object>::alloc<StringObject>(std::to_string(obj->value())));
+            }
+        },
+    }
+};
+}
+
 bool IntegerObject::to_bool()
 {
     return value_;
@@ -211,20 +226,8 @@ Object *IntegerObject::brs(Object *obj)
     }
 }
 
-Address IntegerObject::load_member(const String &name)
+Object *IntegerObject::relocate(void *cell)
 {
-    if (name == "to_str")
-    {
-        return std::make_shared<Variable>(
-            Allocator<Object>::alloc<BuiltInFunctionObject>([val = value_](Size)
-                {
-                    theCurrContext
-                        ->push(Allocator<Object>::alloc<StringObject>(std::to_string(val)))
-                    ;
-                }
-            )
-        );
-    }
-    return Object::load_member(name);
+    return new (cell) IntegerObject(std::move(*this));
 }
 }
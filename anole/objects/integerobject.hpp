@@ -40,7 +40,8 @@ class IntegerObject : public Object
     Object *band(Object *) override;
     Object *bls(Object *) override;
     Object *brs(Object *) override;
-    Address load_member(const String &name) override;
+
+    Object *relocate(void *cell) override;
 
   private:
     int64_t value_;
@@ -9,80 +9,84 @@ namespace anole
 {
 namespace
 {
-std::map<String, std::function<void(ListObject *)>>
-localBuiltinMethodsForList
+const NativeMethods localBuiltinMethodsForList
 {
-    {"empty", [](ListObject *obj)
-        {
-            theCurrContext->push(obj->objects().empty() ? BoolObject::the_true() : BoolObject::the_false());
-        }
-    },
-    {"size", [](ListObject *obj)
-        {
-            theCurrContext->push(Allocator<Object>::alloc<IntegerObject>(int64_t(obj->objects().size())));
-        }
-    },
-    {"push", [](ListObject *obj)
-        {
-            obj->append(theCurrContext->pop_ptr());
-            theCurrContext->push(NoneObject::one());
-        }
-    },
-    {"pop", [](ListObject *obj)
-        {
-            auto res = obj->objects().back();
-            obj->objects().pop_back();
-            theCurrContext->push(res);
-        }
-    },
-    {"pop_front", [](ListObject *obj)
-        {
-            auto res = obj->objects().front();
-            obj->objects().pop_front();
-            theCurrContext->push(res);
-        }
-    },
-    {"front", [](ListObject *obj)
-        {
-            theCurrContext->push(obj->objects().front());
-        }
-    },
-    {"back", [](ListObject *obj)
-        {
-            theCurrContext->push(obj->objects().back());
-        }
-    },
-    {"clear", [](ListObject *obj)
-        {
-            obj->objects().clear();
-            theCurrContext->push(NoneObject::one());
-        }
-    },
-
-    // used by foreach
-    {"__iterator__", [](ListObject *obj)
-        {
-            theCurrContext
-                ->push(Allocator<Object>::alloc<ListIteratorObject>(obj))
-            ;
+    ObjectType::List,
+    {
+        {"empty", [](ListObject *obj)
+            {
+                theCurrContext->push(obj->objects().empty() ? BoolObject::the_true() : BoolObject::the_false());
+            }
+        },
+        {"size", [](ListObject *obj)
+            {
+                theCurrContext->push(Value::integer(int64_t(obj->objects().size())));
+            }
+        },
+        {"push", [](ListObject *obj)
+            {
+                obj->append(theCurrContext->pop_value());
+                theCurrContext->push(NoneObject::one());
+            }
+        },
+        {"pop", [](ListObject *obj)
+            {
+                auto res = obj->objects().back();
+                obj->objects().pop_back();
+                theCurrContext->push(res);
+            }
+        },
+        {"pop_front", [](ListObject *obj)
+            {
+                auto res = obj->objects().front();
+                obj->objects().pop_front();
+                theCurrContext->push(res);
+            }
+        },
+        {"front", [](ListObject *obj)
+            {
+                theCurrContext->push(obj->objects().front());
+            }
+        },
+        {"back", [](ListObject *obj)
+            {
+                theCurrContext->push(obj->objects().back());
+            }
+        },
+        {"clear", [](ListObject *obj)
+            {
+                obj->objects().clear();
+                theCurrContext->push(NoneObject::one());
+            }
+        },
+
+        // used by foreach
+        {"__iterator__", [](ListObject *obj)
+            {
+                theCurrContext
+                    ->push(Allocator<Object>::alloc<ListIteratorObject>(obj))
+                ;
+            }
         }
     }
 };
 
-std::map<String, std::function<void(ListIteratorObject *)>>
-localBuiltinMethodsForListIterator
+const NativeMethods localBuiltinMethodsForListIterator
 {
-    // used by foreach
-    {"__has_next__", [](ListIteratorObject *obj)
-        {
-            theCurrContext
-                ->push(obj->has_next() ? BoolObject::the_true() : BoolObject::the_false())
-            ;
-        }
-    },
-    {"__next__", [](ListIteratorObject *obj)
-        {
-            theCurrContext->push(obj->next());
+    ObjectType::ListIterator,
+    {
+        // used by foreach
+        {"__has_next__", [](ListIteratorObject *obj)
+            {
+                theCurrContext
+                    ->push(obj->has_next() ? BoolObject::the_true() : BoolObject::the_false())
+                ;
+            }
+        },
+        {"__next__", [](ListIteratorObject *obj)
+            {
+                theCurrContext->push(obj->next());
+            }
         }
     }
 };
@@ -99,9 +103,9 @@ std::list<Address> &ListObject::objects()
     return objects_;
 }
 
-void ListObject::append(Object *obj)
+void ListObject::append(Value value)
 {
-    objects_.push_back(std::make_shared<Variable>(obj));
+    objects_.push_back(std::make_shared<Variable>(value, this));
 }
 
 bool ListObject::to_bool()
@@ -118,7 +122,7 @@ String ListObject::to_str()
         {
             res += ", ";
         }
-        res += (*it)->ptr()->to_str();
+        res += (*it)->value().to_str();
     }
     return res + "]";
 }
@@ -136,10 +140,12 @@ Object *ListObject::add(Object *obj)
         auto res = Allocator<Object>::alloc<ListObject>();
         for (auto &obj : objects_)
         {
+            obj->release();
             res->objects().push_back(obj);
         }
         for (auto &obj : p->objects())
         {
+            obj->release();
             res->objects().push_back(obj);
         }
         return res;
@@ -168,29 +174,23 @@ Address ListObject::index(Object *index)
     }
 }
 
-Address ListObject::load_member(const String &name)
+
+void ListObject::trace(Visitor &visitor)
 {
-    auto method = localBuiltinMethodsForList.find(name);
-    if (method != localBuiltinMethodsForList.end())
+    for (auto &addr : objects_)
     {
-        return std::make_shared<Variable>(
-            Allocator<Object>::alloc<BuiltInFunctionObject>([this, &func = method->second](Size) mutable
-                {
-                    func(this);
-                },
-                this
-            )
-        );
+        visitor.visit(addr);
     }
-    return Object::load_member(name);
 }
 
-void ListObject::collect(std::function<void(Object *)> func)
+Object *ListObject::relocate(void *cell)
 {
-    for (auto &addr : objects_)
+    auto moved = new (cell) ListObject(std::move(*this));
+    for (auto &addr : moved->objects_)
     {
-        func(addr->ptr());
+        addr->relocate_owner(this, moved);
     }
+    return moved;
 }
 
 ListIteratorObject::ListIteratorObject(ListObject *bind)
@@ -210,27 +210,23 @@ Address ListIteratorObject::next()
     return *current_++;
 }
 
-Address ListIteratorObject::load_member(const String &name)
+
+/**
+ * iterators of elements are still valid after the list is moved,
+ *  but the end is not
+*/
+void ListIteratorObject::trace(Visitor &visitor)
 {
-    auto method = localBuiltinMethodsForListIterator.find(name);
-    if (method != localBuiltinMethodsForListIterator.end())
+    auto end = current_ == bind_->objects().end();
+    visitor.visit_place(bind_);
+    if (end)
     {
-        return std::make_shared<Variable>(
-            Allocator<Object>::alloc<BuiltInFunctionObject>(
-                [this, &func = method->second]
-                (Size) mutable
-                {
-                    func(this);
-                },
-                this
-            )
-        );
+        current_ = bind_->objects().end();
     }
-    return Object::load_member(name);
 }
 
-void ListIteratorObject::collect(std::function<void(Object *)> func)
+Object *ListIteratorObject::relocate(void *cell)
 {
-    func(bind_);
+    return new (cell) ListIteratorObject(std::move(*this));
 }
 }
@@ -13,7 +13,7 @@ class ListObject : public Object
     ListObject() noexcept;
 
     std::list<Address> &objects();
-    void append(Object *ptr);
+    void append(Value value);
 
   public:
     bool to_bool() override;
@@ -21,9 +21,9 @@ class ListObject : public Object
     String to_key() override;
     Object *add(Object *) override;
     Address index(Object *) override;
-    Address load_member(const String &name) override;
 
-    void collect(std::function<void(Object *)>) override;
+    void trace(Visitor &visitor) override;
+    Object *relocate(void *cell) override;
 
   private:
     std::list<Address> objects_;
@@ -38,9 +38,8 @@ class ListIteratorObject : public Object
     Address next();
 
   public:
-    Address load_member(const String &name) override;
-
-    void collect(std::function<void(Object *)>) override;
+    void trace(Visitor &visitor) override;
+    Object *relocate(void *cell) override;
 
   private:
     ListObject *bind_;
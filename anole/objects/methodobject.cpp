@@ -16,9 +16,14 @@ void MethodObject::call(Size num)
     callee_->call(num + 1);
 }
 
-void MethodObject::collect(std::function<void(Object *)> func)
+void MethodObject::trace(Visitor &visitor)
 {
-    func(callee_);
-    func(binded_obj_);
+    visitor.visit_place(callee_);
+    visitor.visit_place(binded_obj_);
+}
+
+Object *MethodObject::relocate(void *cell)
+{
+    return new (cell) MethodObject(std::move(*this));
 }
 } // namespace anole
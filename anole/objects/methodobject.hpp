@@ -13,7 +13,8 @@ class MethodObject : public Object
   public:
     void call(Size num) override;
 
-    void collect(std::function<void(Object *)>) override;
+    void trace(Visitor &visitor) override;
+    Object *relocate(void *cell) override;
 
   private:
     Object *callee_;
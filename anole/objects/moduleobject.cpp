@@ -125,7 +125,21 @@ AnoleModuleObject::AnoleModuleObject(const fs::path &path)
     theCurrContext = std::make_shared<Context>(code_);
     theCurrContext->pre_context() = origin;
 
-    if (fs::is_regular_file(ir_path)
+    /**
+     * the cached code and the one compiled by Aot are optimized,
+     *  so they are ignored when the optimizer or the peephole pass is disabled
+    */
+    auto optimized = Optimizer::enabled() && Peephole::enabled();
+    auto so_path = Aot::path_of(path);
+    if (optimized
+        && fs::is_regular_file(so_path)
+        && fs::last_write_time(so_path) >= fs::last_write_time(path)
+        && Aot::load(*code_, so_path))
+    {
+        Context::execute();
+    }
+    else if (optimized
+        && fs::is_regular_file(ir_path)
         && fs::last_write_time(ir_path) >= fs::last_write_time(path)
         && code_->unserialize(ir_path))
     {
@@ -141,18 +155,46 @@ AnoleModuleObject::AnoleModuleObject(const fs::path &path)
 
         Parser parser{fin, path};
 
-        while (auto stmt = parser.gen_statement())
+        Block::StmtList statements;
+        auto run = [this, &statements]
         {
-            stmt->codegen(*code_);
+            Optimizer::optimize(statements);
+            auto from = code_->size();
+            for (auto &stmt : statements)
+            {
+                stmt->codegen(*code_);
+            }
+            statements.clear();
+            Resolver::resolve(*code_, from);
+            Peephole::optimize(*code_, from);
 
           #ifdef _DEBUG
             code_->print(std::cerr);
           #endif
 
             Context::execute();
+        };
+
+        while (auto stmt = parser.gen_statement())
+        {
+            auto declares_op = dynamic_cast<PrefixopDeclarationStmt *>(stmt.get())
+                || dynamic_cast<InfixopDeclarationStmt *>(stmt.get())
+            ;
+            statements.push_back(std::move(stmt));
+            if (!Optimizer::whole_module() || declares_op)
+            {
+                run();
+            }
+        }
+        if (!statements.empty())
+        {
+            run();
         }
 
-        code_->serialize(ir_path);
+        if (optimized)
+        {
+            code_->serialize(ir_path);
+        }
     }
 
   #ifdef _DEBUG
@@ -177,15 +219,29 @@ const SPtr<Code> &AnoleModuleObject::code() const
     return code_;
 }
 
-Address AnoleModuleObject::load_member(const String &name)
+Address AnoleModuleObject::load_member(Atom name)
 {
-    if (scope_->symbols().count(name))
+    if (auto member = scope_->find_local(name))
     {
-        return scope_->load_symbol(name);
+        return member;
     }
     return Object::load_member(name);
 }
 
+Address AnoleModuleObject::load_cached_member(Atom name, MemberCache &cache)
+{
+    if (auto member = scope_->find_local(name, &cache))
+    {
+        return member;
+    }
+    return Object::load_member(name);
+}
+
+void AnoleModuleObject::trace(Visitor &visitor)
+{
+    visitor.visit(scope_);
+}
+
 // assume absolute path
 CppModuleObject::CppModuleObject(const fs::path &path)
   : ModuleObject(ObjectType::CppModule)
@@ -211,11 +267,11 @@ const std::vector<String> *CppModuleObject::names() const
     return names_;
 }
 
-Address CppModuleObject::load_member(const String &name)
+Address CppModuleObject::load_member(Atom name)
 {
     using FuncType = void (*)(Size);
 
-    auto func = reinterpret_cast<FuncType>(dlsym(handle_, name.c_str()));
+    auto func = reinterpret_cast<FuncType>(dlsym(handle_, Atoms::name(name).c_str()));
     if (!func)
     {
         throw RuntimeError(dlerror());
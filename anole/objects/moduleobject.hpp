@@ -30,7 +30,7 @@ class ModuleObject : public Object
     bool good();
 
   public:
-    virtual Address load_member(const String &name) = 0;
+    virtual Address load_member(Atom name) = 0;
 
   protected:
     bool good_;
@@ -45,7 +45,10 @@ class AnoleModuleObject : public ModuleObject
     const SPtr<Code> &code() const;
 
   public:
-    Address load_member(const String &name) override;
+    Address load_member(Atom name) override;
+    Address load_cached_member(Atom name, MemberCache &cache) override;
+
+    void trace(Visitor &visitor) override;
 
   private:
     void init(const std::filesystem::path &path);
@@ -64,7 +67,7 @@ class CppModuleObject : public ModuleObject
     const std::vector<String> *names() const;
 
   public:
-    Address load_member(const String &name) override;
+    Address load_member(Atom name) override;
 
   private:
     void *handle_;
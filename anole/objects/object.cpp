@@ -1,6 +1,6 @@
 #include "objects.hpp"
 
-#include "../runtime/allocator.hpp"
+#include "../runtime/runtime.hpp"
 
 #include <map>
 #include <vector>
@@ -26,7 +26,10 @@ std::vector<String> localMappingTypeStr
     "thunk",
     "cont",
     "anolemodule",
-    "cppmodule"
+    "cppmodule",
+    "class",
+    "method",
+    "instance"
 };
 std::map<String, ObjectType> localMappingStrType
 {
@@ -44,7 +47,10 @@ std::map<String, ObjectType> localMappingStrType
     { "thunk",          ObjectType::Thunk           },
     { "continuation",   ObjectType::Continuation    },
     { "anolemodule",    ObjectType::AnoleModule     },
-    { "cppmodule",      ObjectType::CppModule       }
+    { "cppmodule",      ObjectType::CppModule       },
+    { "class",          ObjectType::Class           },
+    { "method",         ObjectType::Method          },
+    { "instance",       ObjectType::Instance        }
 };
 }
 
@@ -54,18 +60,21 @@ ObjectType Object::add_object_type(const String &literal)
     if (find == localMappingStrType.end())
     {
         localMappingTypeStr.push_back(literal);
-        return localMappingStrType[literal] = static_cast<ObjectType>(localMappingTypeStr.size());
+        return localMappingStrType[literal] = static_cast<ObjectType>(localMappingTypeStr.size() - 1);
     }
     return find->second;
 }
 
+const String &Object::type_name(ObjectType type)
+{
+    return localMappingTypeStr[static_cast<Size>(type)];
+}
+
 Object::~Object() = default;
 
 Object *Object::type()
 {
-    return Allocator<Object>::alloc<StringObject>(
-        localMappingTypeStr[static_cast<Size>(type_)]
-    );
+    return Allocator<Object>::alloc<StringObject>(type_name(type_));
 }
 
 bool Object::to_bool()
@@ -171,9 +180,26 @@ Address Object::index(Object *)
     throw RuntimeError("not support index");
 }
 
-Address Object::load_member(const String &name)
+/**
+ * native methods loaded as members are bound to the object,
+ *  they are called without binding by CallMethod
+*/
+Address Object::load_member(Atom name)
 {
-    throw RuntimeError("no member named " + name);
+    if (auto method = NativeMethods::find(type_, name))
+    {
+        return std::make_shared<Variable>(
+            Allocator<Object>::alloc<BuiltInFunctionObject>(
+                [this, method](Size) { (*method)(this); }, this
+            )
+        );
+    }
+    throw RuntimeError("no member named " + Atoms::name(name));
+}
+
+Address Object::load_cached_member(Atom name, MemberCache &)
+{
+    return load_member(name);
 }
 
 void Object::call(Size arg_num)
@@ -186,18 +212,13 @@ bool Object::is_callable()
     return false;
 }
 
-void Object::collect(std::function<void(Scope *)>)
+void Object::trace(Visitor &)
 {
     // ...
 }
 
-void Object::collect(std::function<void(Object *)>)
+Object *Object::relocate(void *)
 {
-    // ...
-}
-
-void Object::collect(std::function<void(Context *)>)
-{
-    // ...
+    return nullptr;
 }
 }
@@ -3,6 +3,7 @@
 
 #include "../base.hpp"
 #include "../error.hpp"
+#include "../runtime/atom.hpp"
 
 #include <memory>
 #include <functional>
@@ -11,11 +12,14 @@ namespace anole
 {
 class Code;
 class Scope;
+class MemberCache;
 class Context;
+class Visitor;
 class Variable;
 using Address = SPtr<Variable>;
 
-enum class ObjectType : Size
+// types share the word of headers with marks and ages, see Collector
+enum class ObjectType : uint16_t
 {
     None,
     Boolean,
@@ -39,18 +43,27 @@ enum class ObjectType : Size
 
 class Object
 {
+    friend class Heap;
+    friend class Collector;
+
   public:
     static ObjectType add_object_type(const String &literal);
+    static const String &type_name(ObjectType type);
 
   public:
-    constexpr Object(ObjectType type) noexcept : type_(type) {}
+    constexpr Object(ObjectType type) noexcept
+      : type_(type), young_(false), remembered_(false), mark_(0) {}
     virtual ~Object() = 0;
 
     template<ObjectType type>
     bool is() noexcept { return type_ == type; }
     bool is(ObjectType type) noexcept { return type_ == type; }
+    ObjectType type_id() const noexcept { return type_; }
     Object *type();
 
+    // objects allocated since the last collection, see Collector
+    bool is_young() const noexcept { return young_; }
+
   public:
     virtual bool to_bool();
     virtual String to_str();
@@ -74,17 +87,27 @@ class Object
     virtual Object *brs(Object *);
 
     virtual Address index(Object *);
-    virtual Address load_member(const String &name);
+    virtual Address load_member(Atom name);
+    // load the member by LoadMember with its inline cache
+    virtual Address load_cached_member(Atom name, MemberCache &cache);
 
     virtual void call(Size num);
     virtual bool is_callable();
 
-    virtual void collect(std::function<void(Scope *)>);
-    virtual void collect(std::function<void(Object *)>);
-    virtual void collect(std::function<void(Context *)>);
+    // visit objects, scopes and contexts referenced by this object
+    virtual void trace(Visitor &visitor);
+
+    /**
+     * move this object into the cell for compaction and return it,
+     *  or return nullptr if it can't be moved, which is the default
+    */
+    virtual Object *relocate(void *cell);
 
   private:
     ObjectType type_;
+    bool young_;
+    bool remembered_;
+    uint32_t mark_;
 };
 }
 
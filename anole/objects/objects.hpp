@@ -1,6 +1,7 @@
 #ifndef __ANOLE_OBJECTS_HPP__
 #define __ANOLE_OBJECTS_HPP__
 
+#include "value.hpp"
 #include "object.hpp"
 #include "boolobject.hpp"
 #include "contobject.hpp"
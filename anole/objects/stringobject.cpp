@@ -6,27 +6,29 @@ namespace anole
 {
 namespace
 {
-std::map<String, std::function<void(StringObject *)>>
-localBuiltinMethods
+const NativeMethods localBuiltinMethods
 {
-    {"size", [](StringObject *obj)
-        {
-            theCurrContext
-                ->push(Allocator<Object>::alloc<IntegerObject>(
-                    int64_t(obj->value().size()))
-                )
-            ;
-        }
-    },
-    {"to_int", [](StringObject *obj)
-        {
-            theCurrContext
-                ->push(Allocator<Object>::alloc<IntegerObject>(
-                    int64_t(stoll(obj->value())))
-                )
-            ;
-        }
-    },
+    ObjectType::String,
+    {
+        {"size", [](StringObject *obj)
+            {
+                theCurrContext
+                    ->push(Value::integer(
+                        int64_t(obj->value().size()))
+                    )
+                ;
+            }
+        },
+        {"to_int", [](StringObject *obj)
+            {
+                theCurrContext
+                    ->push(Value::integer(
+                        int64_t(stoll(obj->value())))
+                    )
+                ;
+            }
+        },
+    }
 };
 }
 
@@ -139,22 +141,8 @@ Address StringObject::index(Object *index)
     }
 }
 
-Address StringObject::load_member(const String &name)
+Object *StringObject::relocate(void *cell)
 {
-    auto method = localBuiltinMethods.find(name);
-    if (method != localBuiltinMethods.end())
-    {
-        return std::make_shared<Variable>(
-            Allocator<Object>::alloc<BuiltInFunctionObject>(
-                [this, &func = method->second]
-                (Size) mutable
-                {
-                    func(this);
-                },
-                this
-            )
-        );
-    }
-    return Object::load_member(name);
+    return new (cell) StringObject(std::move(*this));
 }
 }
@@ -25,7 +25,8 @@ class StringObject : public Object
     Object *clt(Object *) override;
     Object *cle(Object *) override;
     Address index(Object *) override;
-    Address load_member(const String &name) override;
+
+    Object *relocate(void *cell) override;
 
   private:
     String value_;
@@ -8,7 +8,7 @@ namespace anole
 ThunkObject::ThunkObject(SPtr<Scope> pre_scope, SPtr<Code> code, Size base)
   : Object(ObjectType::Thunk)
   , computed_(false), result_(nullptr)
-  , scope_(std::make_shared<Scope>(pre_scope))
+  , scope_(make_pooled<Scope>(pre_scope))
   , code_(code), base_(base)
 {
     // ...
@@ -16,6 +16,7 @@ ThunkObject::ThunkObject(SPtr<Scope> pre_scope, SPtr<Code> code, Size base)
 
 void ThunkObject::set_result(Address res)
 {
+    Collector::shade(res);
     result_ = res;
     computed_ = true;
 }
@@ -45,16 +46,14 @@ Size ThunkObject::base() const
     return base_;
 }
 
-void ThunkObject::collect(std::function<void(Scope *)> func)
+void ThunkObject::trace(Visitor &visitor)
 {
-    func(scope_.get());
+    visitor.visit(scope_);
+    visitor.visit(result_);
 }
 
-void ThunkObject::collect(std::function<void(Object *)> func)
+Object *ThunkObject::relocate(void *cell)
 {
-    if (result_)
-    {
-        func(result_->ptr());
-    }
+    return new (cell) ThunkObject(std::move(*this));
 }
 }
@@ -20,8 +20,8 @@ class ThunkObject : public Object
     Size base() const;
 
   public:
-    void collect(std::function<void(Scope *)> func) override;
-    void collect(std::function<void(Object *)> func) override;
+    void trace(Visitor &visitor) override;
+    Object *relocate(void *cell) override;
 
   private:
     bool computed_;
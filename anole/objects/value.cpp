@@ -0,0 +1,321 @@
+#include "objects.hpp"
+
+#include "../runtime/allocator.hpp"
+
+#include <type_traits>
+
+namespace anole
+{
+namespace
+{
+using Method = Object *(Object::*)(Object *);
+
+/**
+ * integers and floats are computed here directly
+ *  even if they are boxed, results will be immediate if possible
+ *
+ * others are boxed and handled by methods of their objects,
+ *  so that errors are the same as before
+*/
+template<typename IntOp, typename FloatOp>
+Value numeric_operation(const Value &lhs, const Value &rhs,
+    IntOp int_op, FloatOp float_op, Method method)
+{
+    int64_t lhs_int, rhs_int;
+    if (lhs.get_integer(lhs_int) && rhs.get_integer(rhs_int))
+    {
+        return int_op(lhs_int, rhs_int);
+    }
+
+    if constexpr (!std::is_same_v<FloatOp, std::nullptr_t>)
+    {
+        double lhs_float, rhs_float;
+        if (lhs.get_float(lhs_float) && rhs.get_float(rhs_float))
+        {
+            return float_op(lhs_float, rhs_float);
+        }
+    }
+
+    return (lhs.box()->*method)(rhs.box());
+}
+
+// integers wrap around like before
+inline int64_t wrap(uint64_t value)
+{
+    return static_cast<int64_t>(value);
+}
+}
+
+Value Value::boxed_integer(int64_t value)
+{
+    return Allocator<Object>::alloc<IntegerObject>(value);
+}
+
+bool Value::get_integer(int64_t &value) const noexcept
+{
+    if (is_integer())
+    {
+        value = as_integer();
+        return true;
+    }
+    else if (is_object() && !is_null() && as_object()->is<ObjectType::Integer>())
+    {
+        value = reinterpret_cast<IntegerObject *>(as_object())->value();
+        return true;
+    }
+    return false;
+}
+
+bool Value::get_float(double &value) const noexcept
+{
+    if (is_float())
+    {
+        value = as_float();
+        return true;
+    }
+    else if (is_object() && !is_null() && as_object()->is<ObjectType::Float>())
+    {
+        value = reinterpret_cast<FloatObject *>(as_object())->value();
+        return true;
+    }
+    return false;
+}
+
+Object *Value::box() const
+{
+    if (is_object())
+    {
+        return as_object();
+    }
+    else if (is_integer())
+    {
+        return Allocator<Object>::alloc<IntegerObject>(as_integer());
+    }
+    else if (is_float())
+    {
+        return Allocator<Object>::alloc<FloatObject>(as_float());
+    }
+    else if (is_boolean())
+    {
+        return as_boolean() ? BoolObject::the_true() : BoolObject::the_false();
+    }
+    else
+    {
+        return NoneObject::one();
+    }
+}
+
+bool Value::to_bool_slow() const
+{
+    if (is_integer())
+    {
+        return as_integer();
+    }
+    else if (is_float())
+    {
+        return as_float();
+    }
+    return box()->to_bool();
+}
+
+String Value::to_str() const
+{
+    if (is_integer())
+    {
+        return std::to_string(as_integer());
+    }
+    else if (is_float())
+    {
+        return std::to_string(as_float());
+    }
+    return box()->to_str();
+}
+
+String Value::to_key() const
+{
+    if (is_integer())
+    {
+        return 'i' + to_str();
+    }
+    else if (is_float())
+    {
+        return 'f' + to_str();
+    }
+    return box()->to_key();
+}
+
+/**
+ * integers and floats with the same value are the same,
+ *  and immediate booleans and none are the same as their objects
+*/
+bool Value::is(Value rhs) const
+{
+    if (bits_ == rhs.bits_)
+    {
+        return true;
+    }
+
+    int64_t lhs_int, rhs_int;
+    if (get_integer(lhs_int) && rhs.get_integer(rhs_int))
+    {
+        return lhs_int == rhs_int;
+    }
+
+    double lhs_float, rhs_float;
+    if (get_float(lhs_float) && rhs.get_float(rhs_float))
+    {
+        return lhs_float == rhs_float;
+    }
+
+    if (is_integer() || is_float() || rhs.is_integer() || rhs.is_float())
+    {
+        return false;
+    }
+    return box() == rhs.box();
+}
+
+Value Value::neg() const
+{
+    int64_t int_value;
+    double float_value;
+    if (get_integer(int_value))
+    {
+        return integer(wrap(-uint64_t(int_value)));
+    }
+    else if (get_float(float_value))
+    {
+        return floating(-float_value);
+    }
+    return box()->neg();
+}
+
+Value Value::add_slow(Value rhs) const
+{
+    return numeric_operation(*this, rhs,
+        [](int64_t lhs, int64_t rhs) { return integer(wrap(uint64_t(lhs) + uint64_t(rhs))); },
+        [](double lhs, double rhs) { return floating(lhs + rhs); },
+        &Object::add
+    );
+}
+
+Value Value::sub_slow(Value rhs) const
+{
+    return numeric_operation(*this, rhs,
+        [](int64_t lhs, int64_t rhs) { return integer(wrap(uint64_t(lhs) - uint64_t(rhs))); },
+        [](double lhs, double rhs) { return floating(lhs - rhs); },
+        &Object::sub
+    );
+}
+
+Value Value::mul(Value rhs) const
+{
+    return numeric_operation(*this, rhs,
+        [](int64_t lhs, int64_t rhs) { return integer(wrap(uint64_t(lhs) * uint64_t(rhs))); },
+        [](double lhs, double rhs) { return floating(lhs * rhs); },
+        &Object::mul
+    );
+}
+
+Value Value::div(Value rhs) const
+{
+    return numeric_operation(*this, rhs,
+        [](int64_t lhs, int64_t rhs) { return integer(lhs / rhs); },
+        [](double lhs, double rhs) { return floating(lhs / rhs); },
+        &Object::div
+    );
+}
+
+Value Value::mod(Value rhs) const
+{
+    return numeric_operation(*this, rhs,
+        [](int64_t lhs, int64_t rhs) { return integer(lhs % rhs); },
+        nullptr, &Object::mod
+    );
+}
+
+Value Value::ceq_slow(Value rhs) const
+{
+    return numeric_operation(*this, rhs,
+        [](int64_t lhs, int64_t rhs) { return boolean(lhs == rhs); },
+        [](double lhs, double rhs) { return boolean(lhs == rhs); },
+        &Object::ceq
+    );
+}
+
+Value Value::cne_slow(Value rhs) const
+{
+    return numeric_operation(*this, rhs,
+        [](int64_t lhs, int64_t rhs) { return boolean(lhs != rhs); },
+        [](double lhs, double rhs) { return boolean(lhs != rhs); },
+        &Object::cne
+    );
+}
+
+Value Value::clt_slow(Value rhs) const
+{
+    return numeric_operation(*this, rhs,
+        [](int64_t lhs, int64_t rhs) { return boolean(lhs < rhs); },
+        [](double lhs, double rhs) { return boolean(lhs < rhs); },
+        &Object::clt
+    );
+}
+
+Value Value::cle_slow(Value rhs) const
+{
+    return numeric_operation(*this, rhs,
+        [](int64_t lhs, int64_t rhs) { return boolean(lhs <= rhs); },
+        [](double lhs, double rhs) { return boolean(lhs <= rhs); },
+        &Object::cle
+    );
+}
+
+Value Value::bneg() const
+{
+    int64_t value;
+    if (get_integer(value))
+    {
+        return integer(~value);
+    }
+    return box()->bneg();
+}
+
+Value Value::bor(Value rhs) const
+{
+    return numeric_operation(*this, rhs,
+        [](int64_t lhs, int64_t rhs) { return integer(lhs | rhs); },
+        nullptr, &Object::bor
+    );
+}
+
+Value Value::bxor(Value rhs) const
+{
+    return numeric_operation(*this, rhs,
+        [](int64_t lhs, int64_t rhs) { return integer(lhs ^ rhs); },
+        nullptr, &Object::bxor
+    );
+}
+
+Value Value::band(Value rhs) const
+{
+    return numeric_operation(*this, rhs,
+        [](int64_t lhs, int64_t rhs) { return integer(lhs & rhs); },
+        nullptr, &Object::band
+    );
+}
+
+Value Value::bls(Value rhs) const
+{
+    return numeric_operation(*this, rhs,
+        [](int64_t lhs, int64_t rhs) { return integer(lhs << rhs); },
+        nullptr, &Object::bls
+    );
+}
+
+Value Value::brs(Value rhs) const
+{
+    return numeric_operation(*this, rhs,
+        [](int64_t lhs, int64_t rhs) { return integer(lhs >> rhs); },
+        nullptr, &Object::brs
+    );
+}
+}
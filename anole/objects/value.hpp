@@ -0,0 +1,258 @@
+#ifndef __ANOLE_OBJECTS_VALUE_HPP__
+#define __ANOLE_OBJECTS_VALUE_HPP__
+
+#include "object.hpp"
+
+#include <cstring>
+
+namespace anole
+{
+/**
+ * Value is one NaN-boxed word held by variables, slots of the stack
+ *  and constants of codes
+ *
+ * doubles are stored as themselves (NaNs are canonicalized),
+ *  and other kinds of values are encoded in the space of quiet NaNs:
+ *
+ *   object:  0xFFFC + 48 bits pointer
+ *   integer: 0x7FFD + 48 bits signed integer
+ *   boolean: 0x7FFE + 1 bit
+ *   none:    0x7FFF
+ *
+ * so integers which fit in 48 bits, doubles, booleans and none
+ *  are immediate and never allocated on the heap,
+ *  integers out of range fall back to boxed IntegerObjects
+ *
+ * the object of an immediate value is created by box()
+ *  only when it is needed by methods of objects
+*/
+class Value
+{
+  public:
+    static constexpr int64_t kMaxInteger = (int64_t(1) << 47) - 1;
+    static constexpr int64_t kMinInteger = -(int64_t(1) << 47);
+
+    Value() noexcept
+      : bits_(kObjectTag)
+    {
+        // ...
+    }
+
+    Value(Object *ptr) noexcept
+      : bits_(kObjectTag | reinterpret_cast<uint64_t>(ptr))
+    {
+        // ...
+    }
+
+    static bool fits_integer(int64_t value) noexcept
+    {
+        return kMinInteger <= value && value <= kMaxInteger;
+    }
+
+    static Value integer(int64_t value)
+    {
+        if (fits_integer(value))
+        {
+            return Value(kIntegerTag | (uint64_t(value) & kPayloadMask), 0);
+        }
+        return boxed_integer(value);
+    }
+
+    static Value floating(double value) noexcept
+    {
+        if (value != value)
+        {
+            return Value(kCanonicalNaN, 0);
+        }
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return Value(bits, 0);
+    }
+
+    static Value boolean(bool value) noexcept
+    {
+        return Value(kBooleanTag | uint64_t(value), 0);
+    }
+
+    static Value none() noexcept
+    {
+        return Value(kNoneTag, 0);
+    }
+
+    bool is_object() const noexcept
+    {
+        return (bits_ >> 48) == (kObjectTag >> 48);
+    }
+
+    bool is_null() const noexcept
+    {
+        return bits_ == kObjectTag;
+    }
+
+    bool is_integer() const noexcept
+    {
+        return (bits_ >> 48) == (kIntegerTag >> 48);
+    }
+
+    bool is_float() const noexcept
+    {
+        return (bits_ & kQNaN) != kQNaN;
+    }
+
+    bool is_boolean() const noexcept
+    {
+        return (bits_ >> 48) == (kBooleanTag >> 48);
+    }
+
+    bool is_none() const noexcept
+    {
+        return bits_ == kNoneTag;
+    }
+
+    Object *as_object() const noexcept
+    {
+        return reinterpret_cast<Object *>(bits_ & kPayloadMask);
+    }
+
+    int64_t as_integer() const noexcept
+    {
+        return int64_t(bits_ << 16) >> 16;
+    }
+
+    double as_float() const noexcept
+    {
+        double value;
+        std::memcpy(&value, &bits_, sizeof(value));
+        return value;
+    }
+
+    bool as_boolean() const noexcept
+    {
+        return bits_ & 1;
+    }
+
+    // the object held by the value if it lives in the heap
+    Object *heap_object() const noexcept
+    {
+        return is_object() ? as_object() : nullptr;
+    }
+
+    // integers and floats here may be immediate or boxed
+    bool get_integer(int64_t &value) const noexcept;
+    bool get_float(double &value) const noexcept;
+
+    // get the object of the value, immediate values will be boxed
+    Object *box() const;
+
+    bool to_bool() const
+    {
+        if (is_boolean())
+        {
+            return as_boolean();
+        }
+        return to_bool_slow();
+    }
+
+    String to_str() const;
+    String to_key() const;
+
+    bool is(Value rhs) const;
+
+    Value neg() const;
+    Value add(Value rhs) const
+    {
+        if (is_integer() && rhs.is_integer())
+        {
+            return integer(as_integer() + rhs.as_integer());
+        }
+        else if (is_float() && rhs.is_float())
+        {
+            return floating(as_float() + rhs.as_float());
+        }
+        return add_slow(rhs);
+    }
+    Value sub(Value rhs) const
+    {
+        if (is_integer() && rhs.is_integer())
+        {
+            return integer(as_integer() - rhs.as_integer());
+        }
+        else if (is_float() && rhs.is_float())
+        {
+            return floating(as_float() - rhs.as_float());
+        }
+        return sub_slow(rhs);
+    }
+    Value mul(Value rhs) const;
+    Value div(Value rhs) const;
+    Value mod(Value rhs) const;
+    Value ceq(Value rhs) const
+    {
+        if (is_integer() && rhs.is_integer())
+        {
+            return boolean(bits_ == rhs.bits_);
+        }
+        return ceq_slow(rhs);
+    }
+    Value cne(Value rhs) const
+    {
+        if (is_integer() && rhs.is_integer())
+        {
+            return boolean(bits_ != rhs.bits_);
+        }
+        return cne_slow(rhs);
+    }
+    Value clt(Value rhs) const
+    {
+        if (is_integer() && rhs.is_integer())
+        {
+            return boolean(as_integer() < rhs.as_integer());
+        }
+        return clt_slow(rhs);
+    }
+    Value cle(Value rhs) const
+    {
+        if (is_integer() && rhs.is_integer())
+        {
+            return boolean(as_integer() <= rhs.as_integer());
+        }
+        return cle_slow(rhs);
+    }
+    Value bneg() const;
+    Value bor(Value rhs) const;
+    Value bxor(Value rhs) const;
+    Value band(Value rhs) const;
+    Value bls(Value rhs) const;
+    Value brs(Value rhs) const;
+
+  private:
+    static constexpr uint64_t kQNaN        = 0x7FFC'0000'0000'0000;
+    static constexpr uint64_t kCanonicalNaN = 0x7FF8'0000'0000'0000;
+    static constexpr uint64_t kPayloadMask = 0x0000'FFFF'FFFF'FFFF;
+    static constexpr uint64_t kObjectTag   = 0xFFFC'0000'0000'0000;
+    static constexpr uint64_t kIntegerTag  = 0x7FFD'0000'0000'0000;
+    static constexpr uint64_t kBooleanTag  = 0x7FFE'0000'0000'0000;
+    static constexpr uint64_t kNoneTag     = 0x7FFF'0000'0000'0000;
+
+    constexpr Value(uint64_t bits, int) noexcept
+      : bits_(bits)
+    {
+        // ...
+    }
+
+    static Value boxed_integer(int64_t value);
+
+    bool to_bool_slow() const;
+    Value add_slow(Value rhs) const;
+    Value sub_slow(Value rhs) const;
+    Value ceq_slow(Value rhs) const;
+    Value cne_slow(Value rhs) const;
+    Value clt_slow(Value rhs) const;
+    Value cle_slow(Value rhs) const;
+
+  private:
+    uint64_t bits_;
+};
+}
+
+#endif
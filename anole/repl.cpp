@@ -93,22 +93,37 @@ void replrun::run()
 
         theCurrContext->pc() = code->size();
 
-        Ptr<AST> stmt = parser.gen_statement();
+        auto stmt = parser.gen_statement();
         if (stmt == nullptr)
         {
             continue;
         }
 
-        if (stmt->is_expr_stmt())
+        // only expressions typed are printed, not ones in branches taken
+        auto prints = stmt->is_expr_stmt();
+        Block::StmtList statements;
+        statements.push_back(std::move(stmt));
+        Optimizer::optimize(statements);
+
+        auto from = code->size();
+        for (auto &stmt : statements)
         {
-            ArgumentList args;
-            args.emplace_back(move(reinterpret_cast<ExprStmt *>(stmt.get())->expr), false);
-            stmt = std::make_unique<ParenOperatorExpr>(
-                std::make_unique<IdentifierExpr>("println"),
-                std::move(args)
-            );
+            if (prints)
+            {
+                ArgumentList args;
+                args.emplace_back(move(reinterpret_cast<ExprStmt *>(stmt.get())->expr), false);
+                ParenOperatorExpr(
+                    std::make_unique<IdentifierExpr>("println"),
+                    std::move(args)
+                ).codegen(*code);
+            }
+            else
+            {
+                stmt->codegen(*code);
+            }
         }
-        stmt->codegen(*code);
+        Resolver::resolve(*code, from);
+        Peephole::optimize(*code, from);
 
       #ifdef _DEBUG
         code->print(std::cerr);
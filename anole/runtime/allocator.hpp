@@ -1,11 +1,12 @@
 #ifndef __ANOLE_RUNTIME_ALLOCATOR_HPP__
 #define __ANOLE_RUNTIME_ALLOCATOR_HPP__
 
+#include "heap.hpp"
 #include "collector.hpp"
 
 #include "../../light/type_traits.hpp"
 
-#include <set>
+#include <new>
 #include <cassert>
 
 namespace anole
@@ -14,7 +15,9 @@ namespace anole
  * by allocator,
  *  we can allocate memories for objects
  *
- * there is only one global Allocator for each given T
+ * there is only one global Allocator for each given T,
+ *  objects are placed in cells of the heap
+ *  and destroyed by the collector when they are swept
 */
 template<typename T>
 class Allocator
@@ -32,16 +35,6 @@ class Allocator
         return allocator().template allocate<U>(std::forward<Ts>(values)...);
     }
 
-    static void dealloc(Pointer ptr)
-    {
-        allocator().deallocate(ptr);
-    }
-
-    static void dealloc(void *ptr)
-    {
-        dealloc(reinterpret_cast<Pointer>(ptr));
-    }
-
   private:
     static Allocator &allocator()
     {
@@ -58,23 +51,24 @@ class Allocator
     U *allocate(Ts &&...values)
     {
         static_assert(std::is_convertible_v<U *, Pointer>);
-
-        auto ptr = new U(std::forward<Ts>(values)...);
-
-        Collector::mark(Pointer(ptr));
+        static_assert(alignof(U) <= 8, "cells of the heap are aligned to 8 bytes");
+
+        auto mem = Heap::allocate(sizeof(U));
+        U *ptr;
+        try
+        {
+            ptr = new (mem) U(std::forward<Ts>(values)...);
+        }
+        catch (...)
+        {
+            Heap::deallocate(mem);
+            throw;
+        }
+
+        Collector::allocated(ptr);
 
         return ptr;
     }
-
-    void deallocate(Pointer ptr)
-    {
-        delete ptr;
-    }
-
-    void deallocate(void *ptr)
-    {
-        deallocate(reinterpret_cast<Pointer>(ptr));
-    }
 };
 } // namespace anole
 
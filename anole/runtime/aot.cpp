@@ -0,0 +1,377 @@
+#include "aot.hpp"
+#include "runtime.hpp"
+
+#include "../error.hpp"
+#include "../compiler/compiler.hpp"
+
+#include <dlfcn.h>
+
+#include <set>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace anole
+{
+namespace
+{
+/**
+ * types are laid out as the ones of helpers in jit.cpp,
+ *  the last one of helpers is the exit setting the pc,
+ *  and functions return whether the context is switched
+*/
+constexpr const char *kPrologue = R"(
+#include <cstdint>
+
+namespace
+{
+using Size = std::uint64_t;
+
+struct Switch
+{
+    const void *entry;
+    void *ctx;
+};
+
+using Helper = int (*)(void *, Size, Size);
+using Switcher = Switch (*)(void *, Size, Size);
+using Function = bool (*)(void *, Size);
+}
+
+extern "C"
+{
+extern const unsigned char _ANOLE_AOT_CODE[];
+extern const Size _ANOLE_AOT_CODE_SIZE;
+extern const char _ANOLE_AOT_KINDS[];
+extern const void *_ANOLE_AOT_HELPERS[];
+extern const Function _ANOLE_AOT_ENTRIES[];
+}
+
+namespace
+{
+inline int call(void *ctx, Size pc, Size oprand)
+{
+    return reinterpret_cast<Helper>(_ANOLE_AOT_HELPERS[pc])(ctx, pc, oprand);
+}
+
+inline bool switch_at(void *ctx, Size pc, Size oprand)
+{
+    return reinterpret_cast<Switcher>(_ANOLE_AOT_HELPERS[pc])(ctx, pc, oprand).ctx;
+}
+)";
+
+// functions are named by their first instructions
+String function_name(Size begin)
+{
+    return "function_" + std::to_string(begin);
+}
+
+String quote(const String &arg)
+{
+    String quoted = "'";
+    for (auto c : arg)
+    {
+        if (c == '\'')
+        {
+            quoted += "'\\''";
+        }
+        else
+        {
+            quoted += c;
+        }
+    }
+    return quoted + "'";
+}
+
+/**
+ * instructions are emitted by templates of Jit into functions
+ *  by their lambdas, thunks and the top level,
+ *  jumps out of the function exit with the target as pc
+*/
+class Translator
+{
+  public:
+    Translator(const Code &code, const String &serialized)
+      : code_(code), serialized_(serialized), owners_(code.size(), 0)
+    {
+        functions_.insert(0);
+        // inner lambdas are declared after outer ones and override them
+        for (Size pc = 0; pc < code_.size(); ++pc)
+        {
+            Size end;
+            switch (code_.opcode_at(pc))
+            {
+            case Opcode::LambdaDecl:
+                end = unpack_oprand(code_.oprand_at(pc)).second;
+                break;
+            case Opcode::ThunkDecl:
+                end = code_.oprand_at(pc);
+                break;
+            default:
+                continue;
+            }
+            functions_.insert(pc + 1);
+            for (auto i = pc + 1; i < end && i < code_.size(); ++i)
+            {
+                owners_[i] = pc + 1;
+            }
+        }
+    }
+
+    void translate(std::ostream &out)
+    {
+        out << "// compiled by anole --aot from " << code_.path().string()
+            << ", don't edit it\n" << kPrologue << "\n"
+            << "constexpr Size kSize = " << code_.size() << ";\n\n"
+            << "inline bool leave(void *ctx, Size pc)\n"
+            << "{\n"
+            << "    reinterpret_cast<Helper>(_ANOLE_AOT_HELPERS[kSize])(ctx, pc, 0);\n"
+            << "    return false;\n"
+            << "}\n\n";
+
+        for (auto begin : functions_)
+        {
+            out << "bool " << function_name(begin) << "(void *ctx, Size pc);\n";
+        }
+
+        for (auto begin : functions_)
+        {
+            translate_function(out, begin);
+        }
+        out << "}\n";
+
+        out << "\nconst unsigned char _ANOLE_AOT_CODE[] =\n{";
+        for (Size i = 0; i < serialized_.size(); ++i)
+        {
+            out << (i % 16 ? " " : "\n    ")
+                << unsigned(static_cast<unsigned char>(serialized_[i])) << ",";
+        }
+        out << "\n};\n\n"
+            << "const Size _ANOLE_AOT_CODE_SIZE = sizeof(_ANOLE_AOT_CODE);\n\n";
+
+        out << "const char _ANOLE_AOT_KINDS[] =\n    \"";
+        for (Size pc = 0; pc < code_.size(); ++pc)
+        {
+            if (pc && pc % 64 == 0)
+            {
+                out << "\"\n    \"";
+            }
+            out << char('0' + static_cast<int>(Jit::translate(code_, pc).kind));
+        }
+        out << "\";\n\n"
+            << "const void *_ANOLE_AOT_HELPERS[kSize + 1];\n\n";
+
+        out << "const Function _ANOLE_AOT_ENTRIES[kSize + 1] =\n{";
+        for (Size pc = 0; pc < code_.size(); ++pc)
+        {
+            out << "\n    ";
+            if (Jit::translate(code_, pc).kind == Template::Kind::Exit)
+            {
+                out << "nullptr,";
+            }
+            else
+            {
+                out << function_name(owners_[pc]) << ",";
+            }
+        }
+        out << "\n};\n";
+    }
+
+  private:
+    using Template = Jit::Template;
+
+    void translate_function(std::ostream &out, Size begin)
+    {
+        std::vector<Size> pcs;
+        for (Size pc = 0; pc < code_.size(); ++pc)
+        {
+            if (owners_[pc] == begin)
+            {
+                pcs.push_back(pc);
+            }
+        }
+
+        out << "\nbool " << function_name(begin) << "(void *ctx, Size pc)\n"
+            << "{\n"
+            << "    switch (pc)\n"
+            << "    {\n";
+        for (auto pc : pcs)
+        {
+            out << "    case " << pc << ": goto L" << pc << ";\n";
+        }
+        out << "    default: return false;\n"
+            << "    }\n\n";
+
+        for (Size i = 0; i < pcs.size(); ++i)
+        {
+            auto pc = pcs[i];
+            auto follows = i + 1 < pcs.size() && pcs[i + 1] == pc + 1;
+            auto tpl = Jit::translate(code_, pc);
+            auto oprand = code_.oprand_at(pc);
+
+            out << "  L" << pc << ":\n";
+            switch (tpl.kind)
+            {
+            case Template::Kind::Exit:
+                out << "    return leave(ctx, " << pc << ");\n";
+                break;
+
+            case Template::Kind::Skip:
+                out << "    " << (follows ? ";" : go(begin, pc + 1)) << "\n";
+                break;
+
+            case Template::Kind::Jump:
+                if (tpl.target < pc)
+                {
+                    out << "    if (call(ctx, " << pc << ", 0)) return false;\n";
+                }
+                out << "    " << go(begin, tpl.target) << "\n";
+                break;
+
+            case Template::Kind::Plain:
+                out << "    if (call(ctx, " << pc << ", " << oprand << "ULL)) return false;\n";
+                if (!follows)
+                {
+                    out << "    " << go(begin, pc + 1) << "\n";
+                }
+                break;
+
+            case Template::Kind::Branch:
+                out << "    switch (call(ctx, " << pc << ", " << oprand << "ULL))\n"
+                    << "    {\n"
+                    << "    case " << Jit::kNext << ": " << go(begin, tpl.next) << "\n"
+                    << "    case " << Jit::kJump << ": " << go(begin, tpl.target) << "\n"
+                    << "    default: return false;\n"
+                    << "    }\n";
+                break;
+
+            case Template::Kind::Switch:
+                out << "    return switch_at(ctx, " << pc << ", " << oprand << "ULL);\n";
+                break;
+            }
+        }
+        out << "}\n";
+    }
+
+    String go(Size begin, Size target) const
+    {
+        if (target < code_.size() && owners_[target] == begin)
+        {
+            return "goto L" + std::to_string(target) + ";";
+        }
+        return "return leave(ctx, " + std::to_string(target) + ");";
+    }
+
+  private:
+    const Code &code_;
+    const String &serialized_;
+    // the first instruction of the function each instruction belongs to
+    std::vector<Size> owners_;
+    std::set<Size> functions_;
+};
+}
+
+fs::path Aot::path_of(const fs::path &path)
+{
+    auto so_path = path;
+    so_path += ".so";
+    return so_path;
+}
+
+void Aot::compile(Code &code, const fs::path &path)
+{
+    // translated from the code saved, whose instructions are generic
+    std::ostringstream sout;
+    code.serialize(sout);
+    auto serialized = sout.str();
+
+    Code generic{code.from_, code.path_};
+    std::istringstream sin{serialized};
+    if (!generic.unserialize(sin))
+    {
+        throw RuntimeError("cannot translate the code of " + path.string());
+    }
+
+    auto src_path = path;
+    src_path += ".cpp";
+    {
+        std::ofstream fout{src_path};
+        if (!fout.good())
+        {
+            throw RuntimeError("cannot open file " + src_path.string());
+        }
+        Translator{generic, serialized}.translate(fout);
+    }
+
+    auto cxx = std::getenv("CXX");
+    String command = cxx && *cxx ? cxx : "c++";
+    command += " -std=c++17 -O2 -fPIC -shared -o "
+        + quote(path_of(path).string()) + " " + quote(src_path.string());
+    if (std::system(command.c_str()) != 0)
+    {
+        throw RuntimeError("cannot compile " + src_path.string() + " by " + command);
+    }
+    fs::remove(src_path);
+}
+
+bool Aot::load(Code &code, const fs::path &path)
+{
+    auto handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (handle == nullptr)
+    {
+        return false;
+    }
+
+    auto bytes = reinterpret_cast<const char *>(dlsym(handle, "_ANOLE_AOT_CODE"));
+    auto size = reinterpret_cast<const Size *>(dlsym(handle, "_ANOLE_AOT_CODE_SIZE"));
+    auto kinds = reinterpret_cast<const char *>(dlsym(handle, "_ANOLE_AOT_KINDS"));
+    auto helpers = reinterpret_cast<const void **>(dlsym(handle, "_ANOLE_AOT_HELPERS"));
+    auto entries = reinterpret_cast<const void *const *>(dlsym(handle, "_ANOLE_AOT_ENTRIES"));
+    if (!bytes || !size || !kinds || !helpers || !entries)
+    {
+        dlclose(handle);
+        return false;
+    }
+
+    // templates must be the same as the ones it's compiled by
+    Code loaded{code.from_, code.path_};
+    std::istringstream sin{String(bytes, *size)};
+    auto good = loaded.unserialize(sin) && std::strlen(kinds) == loaded.size();
+    for (Size pc = 0; good && pc < loaded.size(); ++pc)
+    {
+        auto tpl = Jit::translate(loaded, pc);
+        good = kinds[pc] == char('0' + static_cast<int>(tpl.kind));
+        helpers[pc] = tpl.helper;
+    }
+    if (!good)
+    {
+        dlclose(handle);
+        return false;
+    }
+    helpers[loaded.size()] = Jit::translate(loaded, loaded.size()).helper;
+
+    loaded.aot_entries_.assign(entries, entries + loaded.size());
+    code = std::move(loaded);
+    loaded_ = true;
+    return true;
+}
+
+void Aot::run(Context *ctx, const void *entry)
+{
+    while (reinterpret_cast<Function>(entry)(ctx, ctx->pc()))
+    {
+        Jit::rethrow_pending();
+        ctx = theCurrContext.get();
+        entry = ctx->code()->aot_entry(ctx->pc());
+        if (entry == nullptr)
+        {
+            return;
+        }
+    }
+    Jit::rethrow_pending();
+}
+}
@@ -0,0 +1,65 @@
+#ifndef __ANOLE_RUNTIME_AOT_HPP__
+#define __ANOLE_RUNTIME_AOT_HPP__
+
+#include "../base.hpp"
+
+#include <filesystem>
+
+namespace anole
+{
+class Code;
+class Context;
+
+/**
+ * Aot compiles codes of modules ahead of time to shared objects,
+ *  the code is translated to C++ source with one function for each lambda,
+ *  thunk and the top level by templates of Jit, and built by the system
+ *  compiler, `$CXX` or `c++`, the serialized code is kept in it too
+ *
+ * module.anole.so is loaded in place of module.anole and its .ir cache
+ *  if it's newer than the source, its code is unserialized as the cache
+ *  and functions are linked to helpers of the running anole by each pc,
+ *  so values, objects and scopes are the same as the interpreter's
+ *
+ * functions are entered like native code of Jit, and they return
+ *  to the interpreter with the pc left in the context at instructions
+ *  they don't compile and after calls and returns, then the next function
+ *  is entered if the context switched to has one
+ *
+ * shared objects are never closed, as constants of codes are never freed
+*/
+class Aot
+{
+  public:
+    // functions return whether native code goes on with the context switched to
+    using Function = bool (*)(Context *, Size);
+
+    // the path of the shared object compiled from the module
+    static std::filesystem::path path_of(const std::filesystem::path &path);
+
+    /**
+     * the code should be run already, or it's not complete,
+     *  errors of the system compiler throw RuntimeError
+    */
+    static void compile(Code &code, const std::filesystem::path &path);
+
+    /**
+     * load the code and functions from the shared object into the empty code,
+     *  return false if it's not compiled by Aot of the same templates
+    */
+    static bool load(Code &code, const std::filesystem::path &path);
+
+    static bool loaded() noexcept
+    {
+        return loaded_;
+    }
+
+    // run functions from the entry until the next context has none
+    static void run(Context *ctx, const void *entry);
+
+  private:
+    static inline bool loaded_ = false;
+};
+}
+
+#endif
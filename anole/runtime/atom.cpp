@@ -0,0 +1,45 @@
+#include "atom.hpp"
+
+#include <deque>
+#include <string_view>
+#include <unordered_map>
+
+namespace anole
+{
+namespace
+{
+// names are never moved, zero is kept for no atom
+std::deque<String> &get_names()
+{
+    static std::deque<String> names { String() };
+    return names;
+}
+
+std::unordered_map<std::string_view, Atom> &get_atoms()
+{
+    static std::unordered_map<std::string_view, Atom> atoms;
+    return atoms;
+}
+}
+
+Atom Atoms::intern(const String &name)
+{
+    auto &atoms = get_atoms();
+    auto find = atoms.find(name);
+    if (find != atoms.end())
+    {
+        return find->second;
+    }
+
+    auto &names = get_names();
+    names.push_back(name);
+    auto atom = static_cast<Atom>(names.size() - 1);
+    atoms.emplace(names.back(), atom);
+    return atom;
+}
+
+const String &Atoms::name(Atom atom)
+{
+    return get_names()[atom];
+}
+}
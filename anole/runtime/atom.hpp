@@ -0,0 +1,24 @@
+#ifndef __ANOLE_RUNTIME_ATOM_HPP__
+#define __ANOLE_RUNTIME_ATOM_HPP__
+
+#include "../base.hpp"
+
+namespace anole
+{
+/**
+ * names are interned as atoms, the same name is always the same atom,
+ *  so that names are hashed and compared as integers
+ *
+ * atoms are never released, and zero is never an atom
+*/
+using Atom = std::uint32_t;
+
+class Atoms
+{
+  public:
+    static Atom intern(const String &name);
+    static const String &name(Atom atom);
+};
+}
+
+#endif
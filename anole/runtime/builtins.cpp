@@ -25,6 +25,7 @@ REGISTER_BUILTIN(eval,
     */
     auto code = std::make_shared<Code>("<eval>", theCurrContext->code_path());
     Parser(ss, "<eval>").gen_statement()->codegen(*code);
+    Peephole::optimize(*code);
     theCurrContext = std::make_shared<Context>(
         theCurrContext, theCurrContext->scope(), code, -1
     );
@@ -41,13 +42,13 @@ REGISTER_BUILTIN(call_with_current_continuation,
         auto func = reinterpret_cast<FunctionObject *>(theCurrContext->pop_ptr());
         // copy current context
         auto cont_obj = Allocator<Object>::alloc<ContObject>(theCurrContext);
-        theCurrContext = std::make_shared<Context>(
+        theCurrContext = make_pooled<Context>(
             theCurrContext, func->scope(), func->code(), func->base()
         );
         // the base => StoreRef/StoreLocal
         theCurrContext->scope()
-            ->create_symbol(std::any_cast<String>(
-                theCurrContext->oprand())
+            ->create_symbol(theCurrContext->code()
+                ->oprand_at<Atom>(theCurrContext->pc())
             )->bind(cont_obj)
         ;
     }
@@ -77,18 +78,18 @@ REGISTER_BUILTIN(id,
 
 REGISTER_BUILTIN(print,
 {
-    if (theCurrContext->top_ptr() != NoneObject::one())
+    if (!theCurrContext->top_value().is(Value::none()))
     {
-        std::cout << theCurrContext->pop_ptr()->to_str();
+        std::cout << theCurrContext->pop_value().to_str();
     }
     theCurrContext->push(NoneObject::one());
 });
 
 REGISTER_BUILTIN(println,
 {
-    if (theCurrContext->top_ptr() != NoneObject::one())
+    if (!theCurrContext->top_value().is(Value::none()))
     {
-        std::cout << theCurrContext->pop_ptr()->to_str() << std::endl;
+        std::cout << theCurrContext->pop_value().to_str() << std::endl;
     }
     theCurrContext->push(NoneObject::one());
 });
@@ -114,11 +115,98 @@ REGISTER_BUILTIN(time,
 
 REGISTER_BUILTIN(str,
 {
-    theCurrContext->push(Allocator<Object>::alloc<StringObject>(theCurrContext->pop_ptr()->to_str()));
+    theCurrContext->push(Allocator<Object>::alloc<StringObject>(theCurrContext->pop_value().to_str()));
 });
 
 REGISTER_BUILTIN(type,
 {
     theCurrContext->push(theCurrContext->pop_ptr()->type());
 });
+
+/**
+ * builtins of the collector are wrapped by the library gc,
+ *  durations of pauses are in nanoseconds
+*/
+REGISTER_BUILTIN(__gc_collect,
+{
+    Collector::collect();
+    theCurrContext->push(NoneObject::one());
+});
+
+REGISTER_BUILTIN(__gc_compact,
+{
+    Collector::compact();
+    theCurrContext->push(NoneObject::one());
+});
+
+REGISTER_BUILTIN(__gc_enable,
+{
+    if (n != 1)
+    {
+        throw RuntimeError("function __gc_enable need 1 argument");
+    }
+    Collector::set_enabled(theCurrContext->pop_value().to_bool());
+    theCurrContext->push(NoneObject::one());
+});
+
+REGISTER_BUILTIN(__gc_enabled,
+{
+    theCurrContext->push(Value::boolean(Collector::enabled()));
+});
+
+REGISTER_BUILTIN(__gc_set_limit,
+{
+    auto bytes = theCurrContext->pop_value();
+    if (n != 1 || !bytes.is_integer() || bytes.as_integer() < 0)
+    {
+        throw RuntimeError("function __gc_set_limit need 1 integer not less than 0");
+    }
+    Collector::set_limit(bytes.as_integer());
+    theCurrContext->push(NoneObject::one());
+});
+
+REGISTER_BUILTIN(__gc_stats,
+{
+    auto pauses = Collector::pause_stats();
+    auto heap = Collector::heap_stats();
+
+    auto stats = Allocator<Object>::alloc<DictObject>();
+    theCurrContext->push(stats);
+    auto insert = [stats](const String &key, Value value)
+    {
+        stats->insert(Allocator<Object>::alloc<StringObject>(key), value);
+    };
+
+    insert("minors", Value::integer(heap.minors));
+    insert("majors", Value::integer(heap.majors));
+    auto buckets = Allocator<Object>::alloc<ListObject>();
+    insert("pauses", buckets);
+    for (auto count : pauses.buckets)
+    {
+        buckets->append(Value::integer(count));
+    }
+    insert("pause_total", Value::integer(pauses.total));
+    insert("pause_max", Value::integer(pauses.max));
+
+    insert("live", Value::integer(heap.live));
+    insert("allocated", Value::integer(heap.allocated));
+    insert("mapped", Value::integer(heap.mapped));
+    insert("limit", Value::integer(heap.limit));
+    insert("compactions", Value::integer(heap.compactions));
+    insert("moved", Value::integer(heap.moved));
+    auto types = Allocator<Object>::alloc<DictObject>();
+    insert("types", types);
+    for (Size type = 0; type < heap.types.size(); ++type)
+    {
+        if (heap.types[type])
+        {
+            types->insert(
+                Allocator<Object>::alloc<StringObject>(
+                    Object::type_name(static_cast<ObjectType>(type))
+                ),
+                Value::integer(heap.types[type])
+            );
+        }
+    }
+});
 }
@@ -2,86 +2,1226 @@
 
 #include "../objects/objects.hpp"
 
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cstdlib>
+#include <unordered_map>
+#include <condition_variable>
+
 namespace anole
 {
-void Collector::try_gc()
+namespace
+{
+// bytes allocated before a minor collection and between slices
+constexpr Size kYoungBytes = Size(1) << 19;
+constexpr Size kSliceBytes = Size(1) << 16;
+// the least bytes allocated and promoted before a major collection
+constexpr Size kMinMajorBytes = Size(4) << 20;
+// pages less full than it are evacuated by compaction
+constexpr double kSparseRatio = 0.5;
+}
+
+void Visitor::visit(const Address &addr)
+{
+    if (addr)
+    {
+        visit_place(addr->value_);
+    }
+}
+
+void Visitor::visit_place(Value &value)
+{
+    if (auto obj = value.heap_object())
+    {
+        visit(obj);
+    }
+}
+
+void Visitor::visit_place(Object *&obj)
+{
+    visit(obj);
+}
+
+// the marker makes everything it visits gray
+class Collector::Marker : public Visitor
+{
+  public:
+    using Visitor::visit;
+
+    Marker(Collector &collector, MarkStack &stack) noexcept
+      : collector_(collector), stack_(stack)
+    {
+        // ...
+    }
+
+    void visit(Object *obj) override
+    {
+        collector_.reach(stack_, obj, Gray::Kind::Object);
+    }
+
+    void visit(const SPtr<Scope> &scope) override
+    {
+        collector_.reach(stack_, scope.get(), Gray::Kind::Scope,
+            marking_ ? scope : nullptr
+        );
+    }
+
+    void visit(const SPtr<Context> &ctx) override
+    {
+        collector_.reach(stack_, ctx.get(), Gray::Kind::Context,
+            marking_ ? ctx : nullptr
+        );
+    }
+
+  private:
+    Collector &collector_;
+    MarkStack &stack_;
+};
+
+/**
+ * the minor marker only makes young objects and contexts gray,
+ *  old objects are regarded as alive,
+ *  and variables of scopes holding young objects are remembered
+*/
+class Collector::MinorMarker : public Visitor
+{
+  public:
+    using Visitor::visit;
+
+    MinorMarker(Collector &collector, MarkStack &stack) noexcept
+      : collector_(collector), stack_(stack)
+    {
+        // ...
+    }
+
+    void visit(Object *obj) override
+    {
+        if (obj && obj->young_)
+        {
+            collector_.reach(stack_, obj, Gray::Kind::Object);
+        }
+    }
+
+    void visit(const SPtr<Scope> &) override
+    {
+        // ...
+    }
+
+    void visit(const SPtr<Context> &ctx) override
+    {
+        collector_.reach(stack_, ctx.get(), Gray::Kind::Context);
+    }
+
+  private:
+    Collector &collector_;
+    MarkStack &stack_;
+};
+
+/**
+ * the relocator traces everything from the roots like the marker,
+ *  and redirects places of moved objects to where they are,
+ *  dicts whose keys are moved are sorted again at last
+ *  when all references are redirected
+*/
+class Collector::Relocator : public Visitor
+{
+  public:
+    using Forwards = std::unordered_map<Object *, Object *>;
+
+    using Visitor::visit;
+    using Visitor::visit_place;
+
+    Relocator(Collector &collector, const Forwards &forwards) noexcept
+      : collector_(collector), forwards_(forwards)
+    {
+        // ...
+    }
+
+    void visit(Object *obj) override
+    {
+        collector_.reach(collector_.main_, obj, Gray::Kind::Object);
+    }
+
+    void visit(const SPtr<Scope> &scope) override
+    {
+        collector_.reach(collector_.main_, scope.get(), Gray::Kind::Scope);
+    }
+
+    void visit(const SPtr<Context> &ctx) override
+    {
+        collector_.reach(collector_.main_, ctx.get(), Gray::Kind::Context);
+    }
+
+    void visit_place(Value &value) override
+    {
+        if (auto obj = value.heap_object())
+        {
+            obj = forward(obj);
+            value = obj;
+            visit(obj);
+        }
+    }
+
+    void visit_place(Object *&obj) override
+    {
+        obj = forward(obj);
+        visit(obj);
+    }
+
+    void rekey(DictObject *dict) override
+    {
+        dicts_.push_back(dict);
+    }
+
+    void rekey_dicts()
+    {
+        for (auto dict : dicts_)
+        {
+            DictObject::DataType data;
+            for (auto &key_addr : dict->data())
+            {
+                data.emplace(forward(key_addr.first), std::move(key_addr.second));
+            }
+            dict->data().swap(data);
+        }
+        dicts_.clear();
+    }
+
+    Object *forward(Object *obj) const
+    {
+        auto find = forwards_.find(obj);
+        return find == forwards_.end() ? obj : find->second;
+    }
+
+  private:
+
+    Collector &collector_;
+    const Forwards &forwards_;
+    std::vector<DictObject *> dicts_;
+};
+
+/**
+ * the budget of a slice shared by marking threads,
+ *  the clock is only read once in a while for it's much slower than tracing
+*/
+class Collector::Budget
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    Budget(Size work, Size micros) noexcept
+      : work_(work), timed_(micros != 0)
+      , deadline_(Clock::now() + std::chrono::microseconds(micros))
+    {
+        // ...
+    }
+
+    // the work which can be done
+    Size remaining() const noexcept
+    {
+        auto spent = spent_.load(std::memory_order_relaxed);
+        return work_ == 0 ? Size(-1) : work_ > spent ? work_ - spent : 0;
+    }
+
+    void spend(Size work) noexcept
+    {
+        spent_.fetch_add(work, std::memory_order_relaxed);
+    }
+
+    bool exhausted() noexcept
+    {
+        if (over_.load(std::memory_order_relaxed))
+        {
+            return true;
+        }
+
+        auto spent = spent_.load(std::memory_order_relaxed);
+        if ((work_ && spent >= work_)
+            || (timed_ && spent - checked_.load(std::memory_order_relaxed) >= 64
+                && (checked_.store(spent, std::memory_order_relaxed),
+                    Clock::now() >= deadline_)))
+        {
+            over_.store(true, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+  private:
+    Size work_;
+    std::atomic<Size> spent_{0};
+    std::atomic<Size> checked_{0};
+    std::atomic<bool> over_{false};
+    bool timed_;
+    Clock::time_point deadline_;
+};
+
+/**
+ * helper threads wait for jobs of marking, in which the program's thread
+ *  works as the first worker too, or for the task of sweeping,
+ *  which is run by the first helper alone while the program goes on
+*/
+class Collector::Helpers
+{
+  public:
+    using Job = std::function<void(Size)>;
+
+    explicit Helpers(Size count)
+    {
+        for (Size i = 0; i < count; ++i)
+        {
+            threads_.emplace_back(&Helpers::loop, this, i);
+        }
+    }
+
+    ~Helpers()
+    {
+        wait();
+        {
+            std::lock_guard<std::mutex> guard(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto &thread : threads_)
+        {
+            thread.join();
+        }
+    }
+
+    Size size() const noexcept
+    {
+        return threads_.size();
+    }
+
+    // the job is called with indices of workers, and zero is the caller
+    void run(const Job &job)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        job_ = &job;
+        running_ = threads_.size();
+        ++round_;
+        lock.unlock();
+        wake_.notify_all();
+
+        job(0);
+
+        lock.lock();
+        done_.wait(lock, [this] { return running_ == 0; });
+    }
+
+    void post(std::function<void()> task)
+    {
+        {
+            std::lock_guard<std::mutex> guard(mutex_);
+            task_ = std::move(task);
+            busy_ = true;
+        }
+        wake_.notify_all();
+    }
+
+    bool busy()
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        return busy_;
+    }
+
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this] { return !busy_; });
+    }
+
+  private:
+    void loop(Size ind)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        // rounds count from zero, one may begin before the thread runs
+        Size round = 0;
+        while (true)
+        {
+            wake_.wait(lock, [&]
+                {
+                    return stop_ || round != round_ || (ind == 0 && task_);
+                }
+            );
+            if (stop_)
+            {
+                return;
+            }
+
+            if (ind == 0 && task_)
+            {
+                auto task = std::move(task_);
+                task_ = nullptr;
+                lock.unlock();
+                task();
+                lock.lock();
+                busy_ = false;
+                done_.notify_all();
+                continue;
+            }
+
+            round = round_;
+            auto job = job_;
+            lock.unlock();
+            (*job)(ind + 1);
+            lock.lock();
+            if (--running_ == 0)
+            {
+                done_.notify_all();
+            }
+        }
+    }
+
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+
+    const Job *job_ = nullptr;
+    Size round_ = 0;
+    Size running_ = 0;
+
+    std::function<void()> task_;
+    bool busy_ = false;
+    bool stop_ = false;
+};
+
+/**
+ * a worker of parallel marking traces things from its own stack,
+ *  and shares half of them once it has many and its shared ones are taken,
+ *  workers out of things steal shared ones from others
+*/
+struct Collector::Worker
+{
+    MarkStack stack;
+    std::mutex mutex;
+    std::vector<Gray> shared;
+    std::atomic<Size> shared_size{0};
+};
+
+void Collector::set_generational(bool generational) noexcept
+{
+    collector().generational_ = generational;
+}
+
+void Collector::set_enabled(bool enabled) noexcept
+{
+    collector().enabled_ = enabled;
+}
+
+bool Collector::enabled() noexcept
+{
+    return collector().enabled_;
+}
+
+void Collector::set_growth(double growth) noexcept
+{
+    collector().growth_ = std::max(growth, 1.0);
+}
+
+void Collector::set_limit(Size bytes) noexcept
+{
+    auto &ref = collector();
+    ref.limit_ = bytes;
+    ref.account();
+    ref.grant();
+}
+
+void Collector::set_compaction(bool compaction) noexcept
+{
+    collector().compaction_ = compaction;
+}
+
+void Collector::compact()
+{
+    auto &ref = collector();
+    auto compaction = ref.compaction_;
+    ref.compaction_ = true;
+    collect();
+    ref.compaction_ = compaction;
+}
+
+void Collector::set_budget(Size work, Size micros) noexcept
+{
+    auto &ref = collector();
+    ref.work_budget_ = work;
+    ref.time_budget_ = micros;
+}
+
+/**
+ * the sweeping helper is waited for at exit,
+ *  so that objects are not destroyed along with statics
+*/
+void Collector::set_threads(Size threads)
+{
+    static bool registered = false;
+    if (threads && !registered)
+    {
+        registered = true;
+        std::atexit([]
+            {
+                if (auto &helpers = collector().helpers_)
+                {
+                    helpers->wait();
+                }
+            }
+        );
+    }
+    collector().helpers_.reset(threads ? new Helpers(threads) : nullptr);
+}
+
+void Collector::set_stats_hook(StatsHook hook)
+{
+    collector().stats_hook_ = std::move(hook);
+}
+
+const Collector::PauseStats &Collector::pause_stats() noexcept
+{
+    return collector().stats_;
+}
+
+Collector::HeapStats Collector::heap_stats()
+{
+    auto &ref = collector();
+    ref.account();
+    return {
+        ref.minors_, ref.majors_,
+        ref.survivors_, ref.survivor_types_,
+        ref.allocated_ + ref.promoted_, Heap::mapped_bytes(), ref.limit_,
+        ref.compactions_, ref.moved_
+    };
+}
+
+/**
+ * objects allocated during marking are gray,
+ *  for they may hold white objects taken off the stack,
+ *  and they are black during sweeping
+*/
+void Collector::allocated(Object *obj)
+{
+    auto &ref = collector();
+    allowance_ -= Heap::size_of(obj);
+    if (ref.phase_ == Phase::Marking)
+    {
+        ref.reach(ref.main_, obj, Gray::Kind::Object);
+    }
+    else if (ref.phase_ == Phase::Sweeping)
+    {
+        obj->mark_ = ref.epoch_;
+    }
+    else if (ref.generational_)
+    {
+        obj->young_ = true;
+        ref.young_.push_back(obj);
+    }
+}
+
+/**
+ * old objects are collected by a major collection
+ *  once bytes promoted reach the threshold, or bytes allocated
+ *  if it's not generational, and until it finishes,
+ *  a slice of it is done whenever the allowance is used up
+ *
+ * each collection or slice is a pause recorded in the stats
+*/
+void Collector::collect_due()
 {
     auto &ref = collector();
-    if (ref.count_ > 10000)
+    ref.account();
+    if (ref.limit_ && Heap::mapped_bytes() >= ref.limit_)
+    {
+        collect();
+        if (Heap::mapped_bytes() >= ref.limit_)
+        {
+            throw RuntimeError("heap reaches the limit of "
+                + std::to_string(ref.limit_) + " bytes"
+            );
+        }
+        return;
+    }
+
+    if (!ref.enabled_)
+    {
+        ref.grant();
+        return;
+    }
+
+    auto begin = Budget::Clock::now();
+    if (ref.phase_ != Phase::Idle)
+    {
+        Budget budget(ref.work_budget_, ref.time_budget_);
+        ref.step(budget);
+    }
+    else if (ref.promoted_ + (ref.generational_ ? 0 : ref.allocated_) >= ref.threshold())
     {
-        ref.count_ = 0;
         ref.gc();
     }
+    else if (ref.generational_ && ref.allocated_ >= kYoungBytes)
+    {
+        ref.minor_gc();
+    }
+    else
+    {
+        ref.grant();
+        return;
+    }
+    ref.record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Budget::Clock::now() - begin
+    ).count());
+    ref.grant();
+}
+
+void Collector::collect()
+{
+    auto &ref = collector();
+    auto begin = Budget::Clock::now();
+    ref.account();
+    ref.complete();
+    ref.start(false);
+    ref.complete();
+    ref.record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Budget::Clock::now() - begin
+    ).count());
+    ref.grant();
+}
+
+void Collector::remember(Variable *var)
+{
+    auto &ref = collector();
+    ref.remembered_variables_.push_back(var);
+    var->remembered_ = ref.remembered_variables_.size();
+}
+
+void Collector::forget(Variable *var) noexcept
+{
+    collector().remembered_variables_[var->remembered_ - 1] = nullptr;
+}
+
+void Collector::write_barrier(Object *owner, Object *target)
+{
+    if (target && target->young_ && !owner->young_ && !owner->remembered_)
+    {
+        owner->remembered_ = true;
+        collector().remembered_objects_.push_back(owner);
+    }
+    shade(target);
+}
+
+void Collector::shade(const Address &addr)
+{
+    if (marking_ && addr)
+    {
+        shade_gray(addr->value().heap_object());
+    }
+}
+
+void Collector::shade_gray(Object *obj)
+{
+    auto &ref = collector();
+    ref.reach(ref.main_, obj, Gray::Kind::Object);
+}
+
+void Collector::forget(Context *ctx) noexcept
+{
+    collector().traced_contexts_[ctx->traced_ - 1] = nullptr;
 }
 
+/**
+ * the collector is never destroyed,
+ *  for contexts and variables may be destroyed after it at exit
+*/
 Collector &Collector::collector()
 {
-    static Collector clctor;
-    return clctor;
+    static auto clctor = new Collector();
+    return *clctor;
 }
 
 Collector::Collector() noexcept
-  : count_(0)
+  : epoch_(0)
+  , phase_(Phase::Idle), work_budget_(10000), time_budget_(0)
+  , sweeping_behind_(false)
+  , generational_(true)
+  , enabled_(true), growth_(2), limit_(0), granted_(0)
+  , allocated_(0), promoted_(0), survivors_(0)
+  , minors_(0), majors_(0)
+  , compaction_(false), compactions_(0), moved_(0)
 {
     // ...
 }
 
+// begin a major collection and do its first slice
 void Collector::gc()
 {
-    /**
-     * collect variables from theCurrContext
-    */
-    collect(theCurrContext.get());
+    start(work_budget_ || time_budget_);
+    Budget budget(work_budget_, time_budget_);
+    step(budget);
+}
+
+/**
+ * marking begins from the current context,
+ *  objects allocated before are counted in survivors once swept
+*/
+void Collector::start(bool incremental)
+{
+    next_epoch();
+    phase_ = Phase::Marking;
+    marking_ = incremental;
+    allocated_ = 0;
+
+    Marker marker(*this, main_);
+    marker.visit(theCurrContext);
+}
+
+/**
+ * a slice traces gray things until the budget is used up,
+ *  once nothing is gray, marking is finished in the slice
+ *  and pages are swept in the following slices,
+ *  or by a helper behind the program if there are helpers
+*/
+void Collector::step(Budget &budget)
+{
+    if (phase_ == Phase::Marking)
+    {
+        if (!mark<Marker>(&budget))
+        {
+            return;
+        }
+        finish_marking();
+    }
+
+    if (sweeping_behind_)
+    {
+        if (helpers_ && helpers_->busy())
+        {
+            return;
+        }
+        sweeping_behind_ = false;
+    }
+    else if (helpers_)
+    {
+        helpers_->post([]
+            {
+                Size cells = 0;
+                while (Heap::sweep_page(cells))
+                {
+                    // ...
+                }
+            }
+        );
+        sweeping_behind_ = true;
+        return;
+    }
+    else
+    {
+        Size cells = 0;
+        while (Heap::sweep_page(cells))
+        {
+            budget.spend(cells);
+            cells = 0;
+            if (budget.exhausted())
+            {
+                return;
+            }
+        }
+    }
+
+    survivors_ = Heap::end_sweep(survivor_types_);
+    ++majors_;
+    phase_ = Phase::Idle;
+    if (compaction_ && Context::executing() <= 1)
+    {
+        compact_pages();
+    }
+    if (stats_hook_)
+    {
+        stats_hook_(stats_);
+    }
+}
+
+// slices are done without a budget until the collection finishes
+void Collector::complete()
+{
+    Budget budget(0, 0);
+    while (phase_ != Phase::Idle)
+    {
+        if (sweeping_behind_ && helpers_)
+        {
+            helpers_->wait();
+        }
+        step(budget);
+    }
+}
+
+/**
+ * stacks of contexts may be changed without barriers,
+ *  so contexts traced before are traced again,
+ *  and things reached by them are traced to the end in the pause
+ *
+ * all survivors will be old,
+ *  then sweeping begins and objects allocated later are black
+*/
+void Collector::finish_marking()
+{
+    Marker marker(*this, main_);
+    marker.visit(theCurrContext);
+    for (Size i = 0; i < traced_contexts_.size(); ++i)
+    {
+        if (auto ctx = traced_contexts_[i])
+        {
+            ctx->trace(marker);
+        }
+    }
+    marking_ = false;
+    mark<Marker>(nullptr);
+
+    for (auto ctx : traced_contexts_)
+    {
+        if (ctx)
+        {
+            ctx->traced_ = 0;
+        }
+    }
+    traced_contexts_.clear();
+
+    for (auto obj : young_)
+    {
+        obj->young_ = false;
+    }
+    young_.clear();
+    forget_all();
+    promoted_ = 0;
+
+    phase_ = Phase::Sweeping;
+    Heap::begin_sweep(epoch_);
+}
+
+/**
+ * objects in sparse pages are moved to other pages,
+ *  and then old ones are destroyed once references are redirected,
+ *  marks are claimed again by the relocator
+ *
+ * young objects are moved too, so the young generation
+ *  and things remembered are redirected as well,
+ *  for they may not be reached from the current context
+*/
+void Collector::compact_pages()
+{
+    auto objects = Heap::begin_evacuate(kSparseRatio);
+    Relocator::Forwards forwards;
+    for (auto obj : objects)
+    {
+        auto size = Heap::size_of(obj);
+        auto cell = Heap::allocate(size);
+        if (auto moved = obj->relocate(cell))
+        {
+            forwards.emplace(obj, moved);
+            moved_ += size;
+        }
+        else
+        {
+            Heap::deallocate(cell);
+        }
+    }
+
+    next_epoch();
+    Relocator relocator(*this, forwards);
+    relocator.visit(theCurrContext);
+    for (auto var : remembered_variables_)
+    {
+        if (var)
+        {
+            relocator.visit_place(var->value_);
+        }
+    }
+    for (auto &obj : remembered_objects_)
+    {
+        obj = relocator.forward(obj);
+        obj->trace(relocator);
+    }
+    trace(relocator, main_, nullptr, Size(-1));
+    relocator.rekey_dicts();
+    for (auto &obj : young_)
+    {
+        obj = relocator.forward(obj);
+    }
+
+    for (auto &old_moved : forwards)
+    {
+        Heap::destroy(old_moved.first);
+    }
+    Heap::end_evacuate();
+    ++compactions_;
+}
+
+void Collector::minor_gc()
+{
+    next_epoch();
+
+    MinorMarker marker(*this, main_);
+    marker.visit(theCurrContext);
+    for (auto var : remembered_variables_)
+    {
+        if (var)
+        {
+            marker.visit(var->value().heap_object());
+        }
+    }
+    for (auto obj : remembered_objects_)
+    {
+        obj->trace(marker);
+    }
+    mark<MinorMarker>(nullptr);
+
+    for (auto obj : young_)
+    {
+        if (obj->mark_ == epoch_)
+        {
+            obj->young_ = false;
+            promoted_ += Heap::size_of(obj);
+        }
+        else
+        {
+            Heap::destroy(obj);
+        }
+    }
+    young_.clear();
+    forget_all();
+    allocated_ = 0;
+    ++minors_;
+}
+
+void Collector::account() noexcept
+{
+    allocated_ += granted_ - allowance_;
+    granted_ = allowance_;
+}
+
+/**
+ * the allowance lasts until the next collection or slice is due,
+ *  or until pages mapped may reach the limit
+*/
+void Collector::grant() noexcept
+{
+    Size allowance;
+    if (phase_ != Phase::Idle)
+    {
+        allowance = kSliceBytes;
+    }
+    else if (generational_)
+    {
+        allowance = kYoungBytes - std::min(allocated_, kYoungBytes);
+    }
+    else
+    {
+        allowance = threshold() - std::min(allocated_ + promoted_, threshold());
+    }
+
+    if (limit_)
+    {
+        auto mapped = Heap::mapped_bytes();
+        allowance = std::min(allowance, limit_ > mapped ? limit_ - mapped : 0);
+    }
+    granted_ = allowance_ = std::ptrdiff_t(allowance);
+}
+
+Size Collector::threshold() const noexcept
+{
+    return std::max(kMinMajorBytes, Size(survivors_ * (growth_ - 1)));
+}
+
+void Collector::next_epoch() noexcept
+{
+    // zero is the mark of things never reached
+    if (++epoch_ == 0)
+    {
+        ++epoch_;
+    }
+}
 
-    auto temp_marked = marked<Object>();
-    for (auto ptr : temp_marked)
+void Collector::forget_all() noexcept
+{
+    for (auto var : remembered_variables_)
     {
-        // if cannot visit the object
-        if (!collected_.count(ptr))
+        if (var)
         {
-            marked<Object>().erase(ptr);
-            Allocator<Object>::dealloc(ptr);
+            var->remembered_ = 0;
         }
     }
+    remembered_variables_.clear();
+
+    for (auto obj : remembered_objects_)
+    {
+        obj->remembered_ = false;
+    }
+    remembered_objects_.clear();
+}
+
+void Collector::record(uint64_t nanos)
+{
+    Size bucket = 0;
+    while (bucket + 1 < PauseStats::kBuckets
+        && (uint64_t(1000) << bucket) <= nanos)
+    {
+        ++bucket;
+    }
+    ++stats_.buckets[bucket];
+    ++stats_.count;
+    stats_.total += nanos;
+    stats_.max = std::max(stats_.max, nanos);
+}
+
+/**
+ * marks are claimed atomically if there are helpers,
+ *  for a thing may be reached by several workers at once
+*/
+bool Collector::claim(uint32_t &mark) noexcept
+{
+    if (__atomic_load_n(&mark, __ATOMIC_RELAXED) == epoch_)
+    {
+        return false;
+    }
+    if (helpers_)
+    {
+        return __atomic_exchange_n(&mark, epoch_, __ATOMIC_RELAXED) != epoch_;
+    }
+    mark = epoch_;
+    return true;
+}
+
+template<typename T>
+void Collector::reach(MarkStack &stack, T *ptr, Gray::Kind kind, SPtr<void> hold)
+{
+    if (ptr && claim(ptr->mark_))
+    {
+        ++stack.reached;
+        stack.grays.push_back({ kind, ptr, std::move(hold) });
+    }
+}
 
-    visited_.clear();
-    collected_.clear();
+/**
+ * things are traced by the program's thread alone
+ *  until there are enough gray things and work to wake helpers for
+*/
+template<typename M>
+bool Collector::mark(Budget *budget)
+{
+    constexpr Size kParallelGrays = 1024;
+
+    auto parallel = helpers_
+        && (budget == nullptr || budget->remaining() >= 4 * kParallelGrays);
+    M marker(*this, main_);
+    if (trace(marker, main_, budget, parallel ? kParallelGrays : Size(-1)))
+    {
+        return true;
+    }
+    if (budget && budget->exhausted())
+    {
+        return false;
+    }
+    return parallel_trace<M>(budget);
 }
 
-void Collector::collect_impl(Scope *scp)
+void Collector::trace_gray(Visitor &marker, MarkStack &stack, Gray &gray)
 {
-    collect(scp->pre_scope_.get());
+    switch (gray.kind)
+    {
+    case Gray::Kind::Object:
+        reinterpret_cast<Object *>(gray.ptr)->trace(marker);
+        break;
+    case Gray::Kind::Scope:
+        reinterpret_cast<Scope *>(gray.ptr)->trace(marker);
+        break;
+    case Gray::Kind::Context:
+    {
+        auto ctx = reinterpret_cast<Context *>(gray.ptr);
+        ctx->trace(marker);
+        if (marking_ && !ctx->traced_)
+        {
+            stack.contexts.push_back(ctx);
+        }
+        break;
+    }
+    }
+}
 
-    for (auto &name_addr : scp->symbols_)
+// contexts are adopted before things held for them are released
+void Collector::adopt_contexts(MarkStack &stack)
+{
+    for (auto ctx : stack.contexts)
     {
-        collect(name_addr.second->ptr());
+        traced_contexts_.push_back(ctx);
+        ctx->traced_ = traced_contexts_.size();
+    }
+    stack.contexts.clear();
+}
+
+bool Collector::trace(Visitor &marker, MarkStack &stack,
+    Budget *budget, Size limit)
+{
+    while (!stack.grays.empty())
+    {
+        if ((budget && budget->exhausted()) || stack.grays.size() >= limit)
+        {
+            return false;
+        }
+
+        auto gray = std::move(stack.grays.back());
+        stack.grays.pop_back();
+        auto reached = stack.reached;
+        trace_gray(marker, stack, gray);
+        adopt_contexts(stack);
+
+        // things reached by it are also the work
+        if (budget)
+        {
+            budget->spend(1 + stack.reached - reached);
+        }
     }
+    return true;
 }
 
-void Collector::collect_impl(Object *ptr)
+/**
+ * gray things are dealt to workers, the program's thread and helpers,
+ *  and marking is finished once all of them are idle,
+ *  or stopped once one of them finds the budget used up,
+ *  then things left are gathered back to the collector's stack
+ *
+ * things held are released by the program's thread after all
+*/
+template<typename M>
+bool Collector::parallel_trace(Budget *budget)
 {
-    collected_.insert(ptr);
+    auto count = helpers_->size() + 1;
+    std::vector<Worker> workers(count);
+    for (Size i = 0; i < main_.grays.size(); ++i)
+    {
+        workers[i % count].stack.grays.push_back(std::move(main_.grays[i]));
+    }
+    main_.grays.clear();
+
+    std::atomic<Size> idle(0);
+    std::atomic<bool> stop(false);
+    helpers_->run([&](Size ind)
+        {
+            auto &self = workers[ind];
+            M marker(*this, self.stack);
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                if (self.stack.grays.empty() && !steal(workers, ind))
+                {
+                    ++idle;
+                    while (idle.load() != count && !stop.load()
+                        && !has_shared(workers))
+                    {
+                        std::this_thread::yield();
+                    }
+                    if (idle.load() == count || stop.load())
+                    {
+                        return;
+                    }
+                    --idle;
+                    continue;
+                }
+
+                if (budget && budget->exhausted())
+                {
+                    stop = true;
+                    return;
+                }
 
-    ptr->collect([this](Scope *scp) { this->collect(scp); });
-    ptr->collect([this](Object *obj) { this->collect(obj); });
-    ptr->collect([this](Context *ctx) { this->collect(ctx); });
+                auto gray = std::move(self.stack.grays.back());
+                self.stack.grays.pop_back();
+                auto reached = self.stack.reached;
+                trace_gray(marker, self.stack, gray);
+                if (gray.hold)
+                {
+                    self.stack.released.push_back(std::move(gray.hold));
+                }
+                if (budget)
+                {
+                    budget->spend(1 + self.stack.reached - reached);
+                }
+                share(self);
+            }
+        }
+    );
+
+    for (auto &worker : workers)
+    {
+        adopt_contexts(worker.stack);
+        for (auto &grays : { &worker.stack.grays, &worker.shared })
+        {
+            main_.grays.insert(main_.grays.end(),
+                std::make_move_iterator(grays->begin()),
+                std::make_move_iterator(grays->end())
+            );
+        }
+    }
+    return main_.grays.empty();
 }
 
-void Collector::collect_impl(Context *ctx)
+bool Collector::steal(std::vector<Worker> &workers, Size ind)
 {
-    collect(ctx->pre_context_.get());
-    collect(ctx->scope_.get());
+    auto &grays = workers[ind].stack.grays;
+    for (Size i = 0; i < workers.size(); ++i)
+    {
+        auto &victim = workers[(ind + i) % workers.size()];
+        if (victim.shared_size.load(std::memory_order_acquire) == 0)
+        {
+            continue;
+        }
+
+        std::lock_guard<std::mutex> guard(victim.mutex);
+        auto &shared = victim.shared;
+        // all shared things of its own and half of others'
+        auto half = i == 0 ? shared.size() : (shared.size() + 1) / 2;
+        if (half == 0)
+        {
+            continue;
+        }
+        grays.insert(grays.end(),
+            std::make_move_iterator(shared.end() - half),
+            std::make_move_iterator(shared.end())
+        );
+        shared.erase(shared.end() - half, shared.end());
+        victim.shared_size.store(shared.size(), std::memory_order_release);
+        return true;
+    }
+    return false;
+}
 
-    // different context may share one same stack
-    if (visited_.count(ctx->stack_.get()))
+// the bottom half is shared, which is reached earlier and may be larger
+void Collector::share(Worker &self)
+{
+    auto &grays = self.stack.grays;
+    if (grays.size() < 64
+        || self.shared_size.load(std::memory_order_relaxed) != 0)
     {
         return;
     }
-    visited_.insert(ctx->stack_.get());
 
-    for (auto &addr : *ctx->stack_)
+    std::lock_guard<std::mutex> guard(self.mutex);
+    auto half = grays.size() / 2;
+    self.shared.insert(self.shared.end(),
+        std::make_move_iterator(grays.begin()),
+        std::make_move_iterator(grays.begin() + half)
+    );
+    grays.erase(grays.begin(), grays.begin() + half);
+    self.shared_size.store(self.shared.size(), std::memory_order_release);
+}
+
+bool Collector::has_shared(std::vector<Worker> &workers) noexcept
+{
+    for (auto &worker : workers)
     {
-        collect(addr->ptr());
+        if (worker.shared_size.load(std::memory_order_acquire))
+        {
+            return true;
+        }
     }
+    return false;
 }
 }
@@ -3,52 +3,240 @@
 
 #include "../base.hpp"
 
-#include <set>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 
 namespace anole
 {
 class Scope;
+class Value;
+class Object;
 class Context;
 class Variable;
+class DictObject;
+using Address = SPtr<Variable>;
+
+/**
+ * objects, scopes and contexts report everything they reference
+ *  to the visitor given to their trace
+ *
+ * objects are visited by their places, variables or members,
+ *  so that they can be redirected to where they are moved by compaction
+*/
+class Visitor
+{
+  public:
+    virtual ~Visitor() = default;
+
+    virtual void visit(Object *obj) = 0;
+    virtual void visit(const SPtr<Scope> &scope) = 0;
+    virtual void visit(const SPtr<Context> &ctx) = 0;
+
+    // visit the object held by the variable, which may be empty
+    void visit(const Address &addr);
+
+    virtual void visit_place(Value &value);
+    virtual void visit_place(Object *&obj);
+    template<typename T>
+    void visit_place(T *&ptr)
+    {
+        Object *obj = ptr;
+        visit_place(obj);
+        ptr = static_cast<T *>(obj);
+    }
+
+    // keys of the dict are moved and it should be sorted again
+    virtual void rekey(DictObject *) {}
+};
 
 /**
  * Collector will collect objects
  *  which are referenced and then deallocate others
  *
  * there is only one global Collector
+ *
+ * it's generational by default, objects are young when allocated
+ *  and promoted to be old in place when they survive a collection,
+ *  minor collections only trace and sweep young objects
+ *  from contexts and remembered variables and objects,
+ *  and old objects are left to major collections
+ *
+ * major collections are incremental,
+ *  they mark and sweep in slices bounded by the budget
+ *  between which the program goes on,
+ *  see try_gc and step for details
+ *
+ * collections are triggered by bytes allocated,
+ *  minor ones whenever the young generation is full,
+ *  and major ones once the heap grows by the growth factor
+ *  from bytes surviving the last major collection
 */
 class Collector
 {
   public:
-    template<typename T>
-    static void mark(T *ptr)
+    /**
+     * pauses of collections are counted in buckets by their durations,
+     *  the i-th bucket counts pauses shorter than 2^i microseconds
+     *  and the last one counts all the longer
+    */
+    struct PauseStats
     {
-        collector().mark_impl(ptr);
-    }
+        static constexpr Size kBuckets = 20;
 
-    template<typename T>
-    static void collect(T *p)
+        Size buckets[kBuckets] = {};
+        Size count = 0;
+        // in nanoseconds
+        uint64_t total = 0;
+        uint64_t max = 0;
+    };
+    using StatsHook = std::function<void(const PauseStats &)>;
+
+    struct HeapStats
     {
-        auto &ref = collector();
-        if (p == nullptr || ref.visited_.count(p))
+        Size minors;
+        Size majors;
+        // bytes surviving the last major collection and by their types
+        Size live;
+        std::vector<Size> types;
+        // bytes allocated since it, and bytes of pages mapped
+        Size allocated;
+        Size mapped;
+        Size limit;
+        // compactions done and bytes moved by them
+        Size compactions;
+        Size moved;
+    };
+
+    static void set_generational(bool generational) noexcept;
+
+    /**
+     * collections are not triggered when the collector is disabled,
+     *  but collect and the limit still work
+    */
+    static void set_enabled(bool enabled) noexcept;
+    static bool enabled() noexcept;
+
+    /**
+     * a major collection begins once bytes allocated and promoted
+     *  since the last one reach the growth factor minus one
+     *  times bytes surviving it, the factor is at least one
+    */
+    static void set_growth(double growth) noexcept;
+
+    /**
+     * once pages mapped reach the limit at a safepoint,
+     *  a full collection is done and RuntimeError is thrown
+     *  if they still reach it, zero is unlimited
+    */
+    static void set_limit(Size bytes) noexcept;
+
+    /**
+     * with compaction, pages of small objects less than half full
+     *  are evacuated once a major collection finishes,
+     *  objects in them are moved to other pages by Object::relocate
+     *  and references to them are redirected by tracing from the roots,
+     *  then the pages become empty and are returned
+     *
+     * it's skipped while native code is running anole code,
+     *  for objects may be held by pointers on the native stack
+    */
+    static void set_compaction(bool compaction) noexcept;
+    // collect and compact in a pause
+    static void compact();
+
+    /**
+     * a slice ends once it has done the work, which are things traced
+     *  and reached or cells swept, or has spent the microseconds,
+     *  zero is unlimited, and major collections mark in one pause
+     *  when both of them are unlimited
+     *
+     * a thing is always traced as a whole and a page swept as a whole,
+     *  so a slice may be over the budget by a large list or dict
+    */
+    static void set_budget(Size work, Size micros) noexcept;
+
+    /**
+     * with helper threads, things are marked by them and the program's
+     *  thread in parallel, and pages are swept by one of them
+     *  while the program goes on, zero means no helpers
+    */
+    static void set_threads(Size threads);
+
+    // the hook is called with stats once a major collection finishes
+    static void set_stats_hook(StatsHook hook);
+    static const PauseStats &pause_stats() noexcept;
+    static HeapStats heap_stats();
+
+    /**
+     * objects are young if they are allocated in the generational mode,
+     *  but they are black if they are allocated during a major collection
+    */
+    static void allocated(Object *obj);
+
+    /**
+     * safepoints are returns and backward jumps,
+     *  where the current context holds everything alive
+    */
+    static bool due() noexcept
+    {
+        return allowance_ <= 0;
+    }
+    static void try_gc()
+    {
+        if (due())
         {
-            return;
+            collect_due();
         }
-        ref.visited_.insert(p);
-        ref.collect_impl(p);
     }
 
-    static void try_gc();
+    // finish the collection in progress and do a full one in a pause
+    static void collect();
 
-  private:
-    static Collector &collector();
+    /**
+     * write barriers remember variables of scopes holding young objects
+     *  and old objects referencing young objects,
+     *  by keys of dicts or variables they own
+    */
+    static void remember(Variable *var);
+    static void forget(Variable *var) noexcept;
+    static void write_barrier(Object *owner, Object *target);
 
-    template<typename T>
-    static std::set<T *> &marked()
+    /**
+     * objects stored anywhere are shaded gray during marking,
+     *  so that no black thing will reference white objects
+     *  except contexts, whose stacks are traced again at last
+    */
+    static void shade(Object *obj)
     {
-        static std::set<T *> mkd;
-        return mkd;
+        if (marking_)
+        {
+            shade_gray(obj);
+        }
     }
+    static void shade(const Address &addr);
+
+    // contexts are forgot when they are destroyed after being traced
+    static void forget(Context *ctx) noexcept;
+
+  private:
+    class Marker;
+    class MinorMarker;
+    class Relocator;
+    class Budget;
+    class Helpers;
+    struct Worker;
+
+    enum class Phase : uint8_t { Idle, Marking, Sweeping };
+
+    // read by write barriers of variables, so it's not in the collector
+    static inline bool marking_ = false;
+    // bytes which can be allocated before the next collection or slice
+    static inline std::ptrdiff_t allowance_ = 0;
+
+    static Collector &collector();
+    static void collect_due();
 
     /**
      * default ctor is private
@@ -60,30 +248,112 @@ class Collector
      * gc can only be called by the collector self
     */
     void gc();
+    void start(bool incremental);
+    void minor_gc();
+    void step(Budget &budget);
+    void complete();
+    void finish_marking();
+    void compact_pages();
+    void account() noexcept;
+    void grant() noexcept;
+    Size threshold() const noexcept;
+    void next_epoch() noexcept;
+    void forget_all() noexcept;
+    void record(uint64_t nanos);
+    static void shade_gray(Object *obj);
 
     /**
-     * record allocated address
-     *  and only recorded address could be deallocated
+     * things are gray when they are reached but not traced yet,
+     *  they wait in the mark stack instead of being traced by recursion,
+     *  so that deep lists or long chains of scopes won't overflow
      *
-     * void record(address);
+     * scopes and contexts are held by the gray entries
+     *  during incremental marking, or they may be gone between slices
     */
-    template<typename T>
-    void mark_impl(T *ptr)
+    struct Gray
     {
-        ++count_;
-        marked<T>().insert(ptr);
-    }
+        enum class Kind : uint8_t { Object, Scope, Context };
+
+        Kind kind;
+        void *ptr;
+        SPtr<void> hold;
+    };
+
+    /**
+     * each worker of parallel marking has its own mark stack,
+     *  and the collector's one is used by the program's thread
+    */
+    struct MarkStack
+    {
+        std::vector<Gray> grays;
+        Size reached = 0;
+        // contexts traced and things held no longer, left to the collector
+        std::vector<Context *> contexts;
+        std::vector<SPtr<void>> released;
+    };
+
+    bool claim(uint32_t &mark) noexcept;
+    template<typename T>
+    void reach(MarkStack &stack, T *ptr, Gray::Kind kind, SPtr<void> hold = nullptr);
+
+    // return false if the budget is used up before nothing is gray
+    template<typename M>
+    bool mark(Budget *budget);
+    // return false if the budget is used up or there are too many gray things
+    bool trace(Visitor &marker, MarkStack &stack, Budget *budget, Size limit);
+    void trace_gray(Visitor &marker, MarkStack &stack, Gray &gray);
+    void adopt_contexts(MarkStack &stack);
+
+    template<typename M>
+    bool parallel_trace(Budget *budget);
+    static bool steal(std::vector<Worker> &workers, Size ind);
+    static void share(Worker &self);
+    static bool has_shared(std::vector<Worker> &workers) noexcept;
+
+    MarkStack main_;
+    /**
+     * marks are epochs of collections instead of bits,
+     *  so marks of objects which are never swept,
+     *  like constants and modules, don't need to be cleared
+    */
+    uint32_t epoch_;
+
+    Phase phase_;
+    Size work_budget_;
+    Size time_budget_;
+    // contexts traced during marking, their stacks will be traced again
+    std::vector<Context *> traced_contexts_;
+    PauseStats stats_;
+    StatsHook stats_hook_;
+
+    Ptr<Helpers> helpers_;
+    // pages are being swept by a helper
+    bool sweeping_behind_;
+
+    bool generational_;
+    std::vector<Object *> young_;
+    std::vector<Variable *> remembered_variables_;
+    std::vector<Object *> remembered_objects_;
 
+    bool enabled_;
+    double growth_;
+    Size limit_;
+    // the allowance granted last, of which the rest is not allocated yet
+    std::ptrdiff_t granted_;
     /**
-     * collect variables
+     * bytes allocated since the last collection,
+     *  promoted since the last major collection and survivors of it
     */
-    void collect_impl(Scope *);
-    void collect_impl(Object *);
-    void collect_impl(Context *);
+    Size allocated_;
+    Size promoted_;
+    Size survivors_;
+    std::vector<Size> survivor_types_;
+    Size minors_;
+    Size majors_;
 
-    std::set<void *> visited_;
-    std::set<Object *> collected_;
-    Size count_;
+    bool compaction_;
+    Size compactions_;
+    Size moved_;
 };
 } // namespace anole
 
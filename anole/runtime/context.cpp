@@ -13,7 +13,7 @@
     #include <iostream>
 #endif
 
-#define OPRAND(T) std::any_cast<const T &>(theCurrContext->oprand())
+#define OPRAND(T) (theCurrContext->code()->oprand_at<T>(theCurrContext->pc()))
 
 namespace fs = std::filesystem;
 
@@ -25,6 +25,179 @@ SPtr<Context> theCurrContext = nullptr;
 namespace
 {
 std::vector<char *> localArgs;
+Size localExecuting = 0;
+
+// count calls of execute running even if they exit by exceptions
+struct Executing
+{
+    Executing() noexcept { ++localExecuting; }
+    ~Executing() { --localExecuting; }
+};
+
+/**
+ * lists and dicts of constants are copied with lists and dicts in them,
+ *  other constants are immutable and shared
+*/
+Value copy_const(Value value)
+{
+    auto obj = value.heap_object();
+    if (obj && obj->is<ObjectType::List>())
+    {
+        auto list = Allocator<Object>::alloc<ListObject>();
+        for (auto &element : reinterpret_cast<ListObject *>(obj)->objects())
+        {
+            list->append(copy_const(element->value()));
+        }
+        return list;
+    }
+    else if (obj && obj->is<ObjectType::Dict>())
+    {
+        auto dict = Allocator<Object>::alloc<DictObject>();
+        for (auto &[key, addr] : reinterpret_cast<DictObject *>(obj)->data())
+        {
+            dict->insert(key, copy_const(addr->value()));
+        }
+        return dict;
+    }
+    return value;
+}
+
+/**
+ * load the variable referenced by the oprand,
+ *  from its slot if it's resolved and set,
+ *  or by its name like before
+*/
+Address load_variable(Context *ctx, Oprand oprand)
+{
+    if (auto addr = find_variable(ctx, oprand))
+    {
+        return *addr;
+    }
+    return ctx->scope()->load_symbol(ctx->code()->atom_at(variable_name(oprand)));
+}
+
+// load the member by LoadMember with its inline cache
+Address load_member(Context *ctx, Object *obj, Oprand oprand)
+{
+    auto cache_name = unpack_oprand(oprand);
+    auto &code = ctx->code();
+    return obj->load_cached_member(
+        code->atom_at(cache_name.second), code->member_cache(cache_name.first)
+    );
+}
+
+/**
+ * the quickened opcode of the generic one for types of the oprands,
+ *  or the generic one itself if there is no such quickened one
+*/
+Opcode quickened_opcode(Opcode opcode, Value lhs, Value rhs)
+{
+    if (lhs.is_integer() && rhs.is_integer())
+    {
+        switch (opcode)
+        {
+        case Opcode::Add: return Opcode::AddIntInt;
+        case Opcode::Sub: return Opcode::SubIntInt;
+        case Opcode::Mul: return Opcode::MulIntInt;
+        case Opcode::CEQ: return Opcode::CEQIntInt;
+        case Opcode::CNE: return Opcode::CNEIntInt;
+        case Opcode::CLT: return Opcode::CLTIntInt;
+        case Opcode::CLE: return Opcode::CLEIntInt;
+        case Opcode::CEQJumpIfNot: return Opcode::CEQIntIntJumpIfNot;
+        case Opcode::CNEJumpIfNot: return Opcode::CNEIntIntJumpIfNot;
+        case Opcode::CLTJumpIfNot: return Opcode::CLTIntIntJumpIfNot;
+        case Opcode::CLEJumpIfNot: return Opcode::CLEIntIntJumpIfNot;
+        default: return opcode;
+        }
+    }
+    else if (lhs.is_float() && rhs.is_float())
+    {
+        switch (opcode)
+        {
+        case Opcode::Add: return Opcode::AddFloatFloat;
+        case Opcode::Sub: return Opcode::SubFloatFloat;
+        case Opcode::Mul: return Opcode::MulFloatFloat;
+        case Opcode::Div: return Opcode::DivFloatFloat;
+        case Opcode::CLT: return Opcode::CLTFloatFloat;
+        case Opcode::CLE: return Opcode::CLEFloatFloat;
+        default: return opcode;
+        }
+    }
+    return opcode;
+}
+
+// count the generic instruction and quicken it when it gets hot
+void quicken(Code &code, Size pc, Value lhs, Value rhs)
+{
+    auto generic = code.opcode_at(pc);
+    auto quickened = quickened_opcode(generic, lhs, rhs);
+    if (quickened == generic)
+    {
+        code.cool_down(pc);
+    }
+    else if (code.heat_up(pc))
+    {
+        code.quicken(pc, quickened);
+    }
+}
+
+/**
+ * quicken the Load by its name after its first execution,
+ *  the builtin is loaded directly if the name is never defined,
+ *  and the global is kept in its cell if the name is only defined
+ *  in the scope at the top, because each code only runs under one
+ *  scope at the top, which is of its module or the REPL,
+ *  so the variable found by the first load is the one of later loads
+*/
+void quicken_load(Context *ctx, Size pc, Atom name, const Address &loaded)
+{
+    auto &code = *ctx->code();
+    auto definitions = Scope::definitions(name);
+    if (definitions == 0)
+    {
+        code.quicken(pc, Opcode::LoadBuiltin);
+    }
+    else if (definitions == 1)
+    {
+        auto top = ctx->scope().get();
+        while (top->pre())
+        {
+            top = top->pre().get();
+        }
+        if (top->find_local(name) == loaded)
+        {
+            code.global_cell(pc) = loaded;
+            code.quicken(pc, Opcode::LoadGlobal);
+        }
+    }
+}
+
+/**
+ * the native method called by CallMethod on the built-in object,
+ *  entries are keyed by types out of the space of layouts
+*/
+const NativeMethod *find_native_method(Context *ctx, Object *obj, Oprand oprand)
+{
+    if (!NativeMethods::has(obj->type_id()))
+    {
+        return nullptr;
+    }
+
+    auto cache_name = unpack_oprand(oprand);
+    auto &code = ctx->code();
+    auto &cache = code->member_cache(cache_name.first);
+    auto key = (Size(1) << 63) | Size(obj->type_id());
+    if (auto entry = cache.find(key))
+    {
+        return entry->method;
+    }
+
+    MemberCache::Entry entry;
+    entry.layout = key;
+    entry.method = NativeMethods::find(obj->type_id(), code->atom_at(cache_name.second));
+    cache.insert(entry);
+    return entry.method;
+}
 }
 
 void Context::set_args(int argc, char *argv[], int start)
@@ -40,15 +213,22 @@ const std::vector<char *> &Context::get_args()
     return localArgs;
 }
 
+Size Context::executing() noexcept
+{
+    return localExecuting;
+}
+
 /**
  * that each continuation continues will
  *  create a new scope pointing to the scope of the resume,
  *  so changes to variables which in the previous scope
  *  may occur when different continuations continue
+ *
+ * the new scope is a fork so that it stays at the same level for slots
 */
 Context::Context(SPtr<Context> resume)
   : pre_context_(resume->pre_context_)
-  , scope_(std::make_shared<Scope>(resume->scope_))
+  , scope_(Scope::fork(resume->scope_))
   , code_(resume->code_), pc_(resume->pc_)
   , stack_(std::make_shared<Stack>(*resume->stack_))
   , call_anchors_(resume->call_anchors_)
@@ -78,31 +258,24 @@ Context::Context(SPtr<Code> code)
 Context::Context(SPtr<Context> pre, SPtr<Scope> scope,
     SPtr<Code> code, Size pc)
   : pre_context_(pre)
-  , scope_(std::make_shared<Scope>(scope))
+  , scope_(make_pooled<Scope>(scope))
   , code_(std::move(code)), pc_(pc)
   , stack_(pre->stack_)
 {
     // ...
 }
 
-SPtr<Context> &Context::pre_context()
-{
-    return pre_context_;
-}
-
-SPtr<Scope> &Context::scope()
-{
-    return scope_;
-}
-
-SPtr<Code> &Context::code()
+Context::~Context()
 {
-    return code_;
+    if (traced_)
+    {
+        Collector::forget(this);
+    }
 }
 
-Size &Context::pc() noexcept
+SPtr<Context> &Context::pre_context()
 {
-    return pc_;
+    return pre_context_;
 }
 
 const Opcode &Context::opcode() const
@@ -110,47 +283,125 @@ const Opcode &Context::opcode() const
     return code_->opcode_at(pc_);
 }
 
-const std::any &Context::oprand() const
+const Oprand &Context::oprand() const
 {
     return code_->oprand_at(pc_);
 }
 
-void Context::push(Object *ptr)
+const Address &Context::top_address()
 {
-    stack_->push_back(std::make_shared<Variable>(ptr));
+    return stack_->back().address();
 }
 
-void Context::push(Address addr)
+/**
+ * variables don't keep their names,
+ *  the name is recovered from oprands of instructions before the current one
+ *  in the function or thunk running it, only when an error is reported
+ *
+ * a load whose name still finds the variable is exact,
+ *  otherwise the nearest member or module is assumed,
+ *  and it's empty if there is neither of them
+*/
+String Context::name_of(const Address &addr)
 {
-    stack_->push_back(addr);
-}
+    auto end = std::min(pc_, code_->size());
 
-const Address &Context::top_address() const
-{
-    return stack_->back();
+    // the body of a function or thunk begins after its declaration
+    auto target_of = [this](Size i) -> Size
+    {
+        const auto &ins = code_->ins_at(i);
+        switch (ins.opcode)
+        {
+        case Opcode::LambdaDecl:
+            return unpack_oprand(ins.oprand).second;
+        case Opcode::ThunkDecl:
+            return ins.oprand;
+        default:
+            return 0;
+        }
+    };
+    Size begin = 0;
+    for (auto i = end; i-- > 0;)
+    {
+        if (target_of(i) > end)
+        {
+            begin = i + 1;
+            break;
+        }
+    }
+
+    String exact, nearest;
+    for (auto i = begin; i < end; ++i)
+    {
+        // bodies of nested functions and thunks are skipped
+        if (auto target = target_of(i))
+        {
+            i = target - 1;
+            continue;
+        }
+
+        const auto &ins = code_->ins_at(i);
+        switch (ins.opcode)
+        {
+        case Opcode::Load:
+        case Opcode::LoadBuiltin:
+        case Opcode::LoadGlobal:
+        case Opcode::LoadLocal:
+        case Opcode::LoadUpvalue:
+        case Opcode::LoadLoadAdd:
+        case Opcode::LoadConstAdd:
+        case Opcode::LoadConstSub:
+        case Opcode::LoadStorePop:
+        {
+            auto name = variable_name(ins.oprand);
+            if (scope_->find_symbol(code_->atom_at(name)) == addr)
+            {
+                exact = code_->name_at(name);
+            }
+        }
+            break;
+
+        case Opcode::LoadMember:
+        case Opcode::CallMethod:
+            nearest = code_->name_at(unpack_oprand(ins.oprand).second);
+            break;
+
+        case Opcode::Import:
+        case Opcode::ImportPath:
+        case Opcode::ImportPart:
+            nearest = code_->name_at(ins.oprand);
+            break;
+
+        default:
+            break;
+        }
+    }
+    return exact.empty() ? nearest : exact;
 }
 
-void Context::set_top(Address addr)
+String Context::unbound_error(const Address &addr)
 {
-    stack_->back() = addr;
+    auto name = name_of(addr);
+    if (name.empty())
+    {
+        return "var doesn't reference to any object";
+    }
+    return "var named " + name + " doesn't reference to any object";
 }
 
-void Context::set_top(Object *ptr)
+void Context::set_top(Address addr)
 {
-    stack_->back() = std::make_shared<Variable>(ptr);
+    stack_->back() = Slot(std::move(addr));
 }
 
 void Context::pop(Size num)
 {
-    for (Size i = 0; i < num; ++i)
-    {
-        stack_->pop_back();
-    }
+    stack_->erase(stack_->end() - num, stack_->end());
 }
 
 Address Context::pop_address()
 {
-    auto res = stack_->back();
+    auto res = std::move(stack_->back().address());
     stack_->pop_back();
     return res;
 }
@@ -160,11 +411,6 @@ Size Context::size() const
     return stack_->size();
 }
 
-Context::Stack *Context::get_stack()
-{
-    return stack_.get();
-}
-
 const fs::path &Context::code_path() const
 {
     return code_->path();
@@ -172,25 +418,53 @@ const fs::path &Context::code_path() const
 
 void Context::set_call_anchor()
 {
-    call_anchors_.push(stack_->size());
+    call_anchors_.push_back(stack_->size());
 }
 
 Size Context::get_call_args_num()
 {
-    auto n = stack_->size() - call_anchors_.top();
-    call_anchors_.pop();
+    auto n = stack_->size() - call_anchors_.back();
+    call_anchors_.pop_back();
     return n;
 }
 
-namespace op_handles
+void Context::trace(Visitor &visitor)
 {
-void pop_handle()
+    visitor.visit(pre_context_);
+    visitor.visit(scope_);
+
+    if (pre_context_ && pre_context_->stack_ == stack_)
+    {
+        return;
+    }
+    for (auto &slot : *stack_)
+    {
+        slot.trace(visitor);
+    }
+}
+
+void Context::Slot::trace(Visitor &visitor)
 {
-    const auto &num = OPRAND(Size);
-    theCurrContext->pop(num);
-    ++theCurrContext->pc();
+    if (addr_)
+    {
+        visitor.visit(addr_);
+    }
+    else
+    {
+        visitor.visit_place(value_);
+    }
 }
 
+/**
+ * handlers for instructions which may switch theCurrContext
+ *  or are too cold to be worth inlining into the dispatch loop
+ *
+ * they work on theCurrContext directly,
+ *  so the registers of the dispatch loop must be saved before calling them
+ *  and reloaded after that
+*/
+namespace op_handles
+{
 void import_handle()
 {
     const auto &name = OPRAND(String);
@@ -221,7 +495,7 @@ void importall_handle()
 {
     if (dynamic_cast<ModuleObject *>(theCurrContext->top_ptr()) == nullptr)
     {
-        throw RuntimeError(theCurrContext->top_address()->called_name() + " is not a module");
+        throw RuntimeError(theCurrContext->name_of(theCurrContext->top_address()) + " is not a module");
     }
 
     auto mod = theCurrContext->pop_ptr<ModuleObject>();
@@ -229,12 +503,11 @@ void importall_handle()
     if (mod->is<ObjectType::AnoleModule>())
     {
         auto anole_mod = reinterpret_cast<AnoleModuleObject *>(mod);
-        for (const auto &name_ptr : anole_mod->scope()->symbols())
-        {
-            theCurrContext->scope()->create_symbol(
-                name_ptr.first, name_ptr.second
-            );
-        }
+        anole_mod->scope()->symbols().for_each([](Atom name, const Address &addr)
+            {
+                theCurrContext->scope()->create_symbol(name, addr);
+            }
+        );
     }
     else
     {
@@ -246,22 +519,26 @@ void importall_handle()
         }
         for (const auto &name : *names)
         {
+            auto atom = Atoms::intern(name);
             theCurrContext->scope()->create_symbol(
-                name, cpp_mod->load_member(name)
+                atom, cpp_mod->load_member(atom)
             );
         }
     }
 
+    // imported names may shadow variables in slots
+    theCurrContext->scope()->clear_slots();
+
     ++theCurrContext->pc();
 }
 
 void importpart_handle()
 {
-    const auto &name = OPRAND(String);
+    auto name = OPRAND(Atom);
 
     if (dynamic_cast<ModuleObject *>(theCurrContext->top_ptr()) == nullptr)
     {
-        throw RuntimeError(theCurrContext->top_address()->called_name() + " is not a module");
+        throw RuntimeError(theCurrContext->name_of(theCurrContext->top_address()) + " is not a module");
     }
 
     theCurrContext->push(
@@ -270,60 +547,10 @@ void importpart_handle()
     ++theCurrContext->pc();
 }
 
-void load_handle()
-{
-    const auto &name = OPRAND(String);
-    auto addr = theCurrContext->scope()->load_symbol(name);
-
-    if (addr->ptr() == nullptr || !addr->ptr()->is<ObjectType::Thunk>())
-    {
-        theCurrContext->push(addr);
-        ++theCurrContext->pc();
-    }
-    else
-    {
-        auto thunk = reinterpret_cast<ThunkObject *>(addr->ptr());
-        if (thunk->computed())
-        {
-            theCurrContext->push(thunk->result());
-            ++theCurrContext->pc();
-        }
-        else
-        {
-            theCurrContext->push(addr);
-            theCurrContext = std::make_shared<Context>(
-                theCurrContext, thunk->scope(), thunk->code(), thunk->base()
-            );
-        }
-    }
-}
-
-void loadconst_handle()
-{
-    theCurrContext->push(theCurrContext->code()->load_const(OPRAND(Size)));
-    ++theCurrContext->pc();
-}
-
-void loadmember_handle()
-{
-    const auto &name = OPRAND(String);
-    auto address = theCurrContext->pop_ptr()->load_member(name);
-    theCurrContext->push(address);
-    ++theCurrContext->pc();
-}
-
-void store_handle()
-{
-    auto addr = theCurrContext->pop_address();
-    addr->bind(theCurrContext->pop_ptr());
-    theCurrContext->push(addr);
-    ++theCurrContext->pc();
-}
-
 void storeref_handle()
 {
     theCurrContext->scope()->create_symbol(
-        OPRAND(String), theCurrContext->pop_address()
+        OPRAND(Atom), theCurrContext->pop_address()
     );
     ++theCurrContext->pc();
 }
@@ -331,30 +558,18 @@ void storeref_handle()
 void storelocal_handle()
 {
     theCurrContext->scope()
-        ->create_symbol(OPRAND(String))
-            ->bind(theCurrContext->pop_ptr())
+        ->create_symbol(OPRAND(Atom))
+            ->bind(theCurrContext->pop_value())
     ;
     ++theCurrContext->pc();
 }
 
-void newscope_handle()
-{
-    theCurrContext->scope() = std::make_shared<Scope>(
-        theCurrContext->scope()
-    );
-    ++theCurrContext->pc();
-}
-
-void endscope_handle()
-{
-    auto &cur_scope = theCurrContext->scope();
-    cur_scope = cur_scope->pre();
-    ++theCurrContext->pc();
-}
-
-void callac_handle()
+void storerefslot_handle()
 {
-    theCurrContext->set_call_anchor();
+    auto oprand = theCurrContext->code()->oprand_at(theCurrContext->pc());
+    auto addr = theCurrContext->pop_address();
+    theCurrContext->scope()->create_symbol(OPRAND(Atom), addr);
+    theCurrContext->scope()->set_slot(variable_slot(oprand), std::move(addr));
     ++theCurrContext->pc();
 }
 
@@ -386,69 +601,71 @@ void fastcall_handle()
     callee->call(OPRAND(Size));
 }
 
-void return_handle()
+/**
+ * functions, methods and classes called in tail positions
+ *  run in new frames above callers, which are replaced by them,
+ *  so they return to where callers would return
+ *  and tail calls in a row take constant frames
+ *
+ * the replacement is a safepoint like returns,
+ *  since it may be the only one in a loop of tail calls
+*/
+void replace_frame(const SPtr<Context> &caller, bool replaceable)
 {
-    auto pre_context = theCurrContext->pre_context();
-    if (theCurrContext->get_stack() != pre_context->get_stack())
+    if (replaceable && theCurrContext != caller
+        && theCurrContext->pre_context() == caller && caller->pre_context())
     {
-        pre_context->push(theCurrContext->pop_address());
+        theCurrContext->pre_context() = caller->pre_context();
+        Collector::try_gc();
     }
-    theCurrContext = pre_context;
-    ++theCurrContext->pc();
-
-    Collector::try_gc();
 }
 
-void returnnone_handle()
+bool replaceable(Object *callee)
 {
-    theCurrContext = theCurrContext->pre_context();
-    theCurrContext->push(NoneObject::one());
-    ++theCurrContext->pc();
-
-    Collector::try_gc();
+    return callee->is<ObjectType::Func>()
+        || callee->is<ObjectType::Method>()
+        || callee->is<ObjectType::Class>()
+    ;
 }
 
-void jump_handle()
+void tailcall_handle()
 {
-    theCurrContext->pc() = OPRAND(Size);
+    auto caller = theCurrContext;
+    auto callee = caller->pop_ptr();
+    auto can_replace = replaceable(callee);
+    callee->call(caller->get_call_args_num());
+    replace_frame(caller, can_replace);
 }
 
-void jumpif_handle()
+void fasttailcall_handle()
 {
-    if (theCurrContext->pop_ptr()->to_bool())
-    {
-        theCurrContext->pc() = OPRAND(Size);
-    }
-    else
-    {
-        ++theCurrContext->pc();
-    }
+    auto caller = theCurrContext;
+    auto callee = caller->pop_ptr();
+    auto can_replace = replaceable(callee);
+    callee->call(OPRAND(Size));
+    replace_frame(caller, can_replace);
 }
 
-void jumpifnot_handle()
+void return_handle()
 {
-    if (!theCurrContext->pop_ptr()->to_bool())
-    {
-        theCurrContext->pc() = OPRAND(Size);
-    }
-    else
+    auto pre_context = theCurrContext->pre_context();
+    if (theCurrContext->get_stack() != pre_context->get_stack())
     {
-        ++theCurrContext->pc();
+        pre_context->push(theCurrContext->pop_address());
     }
+    theCurrContext = pre_context;
+    ++theCurrContext->pc();
+
+    Collector::try_gc();
 }
 
-void match_handle()
+void returnnone_handle()
 {
-    auto key = theCurrContext->pop_ptr();
-    if (theCurrContext->top_ptr()->ceq(key)->to_bool())
-    {
-        theCurrContext->pop();
-        theCurrContext->pc() = OPRAND(Size);
-    }
-    else
-    {
-        ++theCurrContext->pc();
-    }
+    theCurrContext = theCurrContext->pre_context();
+    theCurrContext->push(NoneObject::one());
+    ++theCurrContext->pc();
+
+    Collector::try_gc();
 }
 
 void addprefixop_handle()
@@ -460,73 +677,41 @@ void addprefixop_handle()
 void addinfixop_handle()
 {
     using type = std::pair<String, Size>;
-    const auto &op_p = OPRAND(type);
+    auto op_p = OPRAND(type);
     Parser::add_infixop(op_p.first, op_p.second);
     ++theCurrContext->pc();
 }
 
+/**
+ * that Pack is executed
+ *  means no arguments now
+ *
+ * a empty list will be the packed result
+*/
 void pack_handle()
 {
-    /**
-     * that pack_handle is called
-     *  means no arguments now
-     *
-     * a empty list will be the packed result
-    */
-   theCurrContext->push(Allocator<Object>::alloc<ListObject>());
+    theCurrContext->push(Allocator<Object>::alloc<ListObject>());
     ++theCurrContext->pc();
 }
 
-void unpack_handle()
+void lambdadecl_handle()
 {
-    const auto &n = OPRAND(Size);
+    auto &pc = theCurrContext->pc();
+    auto num_target = unpack_oprand(theCurrContext->code()->oprand_at(pc));
+    theCurrContext->push(Allocator<Object>::alloc<FunctionObject>(
+        theCurrContext->scope(), theCurrContext->code(), pc + 1, num_target.first
+    ));
+    pc = num_target.second;
+}
 
-    if (theCurrContext->top_ptr()->is<ObjectType::List>())
-    {
-        auto l = theCurrContext->top_ptr<ListObject>();
-
-        if (n && l->objects().size() != n)
-        {
-            throw RuntimeError(
-                "expect " + std::to_string(n) +
-                " but given " + std::to_string(l->objects().size())
-            );
-        }
-
-        theCurrContext->pop();
-        for (auto it = l->objects().rbegin();
-            it != l->objects().rend(); ++it)
-        {
-            theCurrContext->push(*it);
-        }
-    }
-    else
-    {
-        throw RuntimeError("expect list expr");
-    }
-
-    ++theCurrContext->pc();
-}
-
-void lambdadecl_handle()
-{
-    using type = std::pair<Size, Size>;
-    const auto &num_target = OPRAND(type);
-    theCurrContext->push(Allocator<Object>::alloc<FunctionObject>(
-        theCurrContext->scope(), theCurrContext->code(),
-        theCurrContext->pc() + 1, num_target.first
-    ));
-    theCurrContext->pc() = num_target.second;
-}
-
-void thunkdecl_handle()
-{
-    theCurrContext->push(Allocator<Object>::alloc<ThunkObject>(
-        theCurrContext->scope(), theCurrContext->code(),
-        theCurrContext->pc() + 1
-    ));
-    theCurrContext->pc() = OPRAND(Size);
-}
+void thunkdecl_handle()
+{
+    auto &pc = theCurrContext->pc();
+    theCurrContext->push(Allocator<Object>::alloc<ThunkObject>(
+        theCurrContext->scope(), theCurrContext->code(), pc + 1
+    ));
+    pc = theCurrContext->code()->oprand_at(pc);
+}
 
 void thunkover_handle()
 {
@@ -537,141 +722,6 @@ void thunkover_handle()
     ++theCurrContext->pc();
 }
 
-void neg_handle()
-{
-    theCurrContext->push(theCurrContext->pop_ptr()->neg());
-    ++theCurrContext->pc();
-}
-
-void add_handle()
-{
-    auto rhs = theCurrContext->pop_ptr();
-    auto lhs = theCurrContext->top_ptr();
-    theCurrContext->set_top(lhs->add(rhs));
-    ++theCurrContext->pc();
-}
-
-void sub_handle()
-{
-    auto rhs = theCurrContext->pop_ptr();
-    auto lhs = theCurrContext->top_ptr();
-    theCurrContext->set_top(lhs->sub(rhs));
-    ++theCurrContext->pc();
-}
-
-void mul_handle()
-{
-    auto rhs = theCurrContext->pop_ptr();
-    auto lhs = theCurrContext->top_ptr();
-    theCurrContext->set_top(lhs->mul(rhs));
-    ++theCurrContext->pc();
-}
-
-void div_handle()
-{
-    auto rhs = theCurrContext->pop_ptr();
-    auto lhs = theCurrContext->top_ptr();
-    theCurrContext->set_top(lhs->div(rhs));
-    ++theCurrContext->pc();
-}
-
-void mod_handle()
-{
-    auto rhs = theCurrContext->pop_ptr();
-    auto lhs = theCurrContext->top_ptr();
-    theCurrContext->set_top(lhs->mod(rhs));
-    ++theCurrContext->pc();
-}
-
-void is_handle()
-{
-    auto rhs = theCurrContext->pop_ptr();
-    theCurrContext->set_top(
-        theCurrContext->top_ptr() == rhs
-        ? BoolObject::the_true()
-        : BoolObject::the_false()
-    );
-    ++theCurrContext->pc();
-}
-
-void ceq_handle()
-{
-    auto rhs = theCurrContext->pop_ptr();
-    auto lhs = theCurrContext->top_ptr();
-    theCurrContext->set_top(lhs->ceq(rhs));
-    ++theCurrContext->pc();
-}
-
-void cne_handle()
-{
-    auto rhs = theCurrContext->pop_ptr();
-    auto lhs = theCurrContext->top_ptr();
-    theCurrContext->set_top(lhs->cne(rhs));
-    ++theCurrContext->pc();
-}
-
-void clt_handle()
-{
-    auto rhs = theCurrContext->pop_ptr();
-    auto lhs = theCurrContext->top_ptr();
-    theCurrContext->set_top(lhs->clt(rhs));
-    ++theCurrContext->pc();
-}
-
-void cle_handle()
-{
-    auto rhs = theCurrContext->pop_ptr();
-    auto lhs = theCurrContext->top_ptr();
-    theCurrContext->set_top(lhs->cle(rhs));
-    ++theCurrContext->pc();
-}
-
-void bneg_handle()
-{
-    theCurrContext->push(theCurrContext->pop_ptr()->bneg());
-    ++theCurrContext->pc();
-}
-
-void bor_handle()
-{
-    auto rhs = theCurrContext->pop_ptr();
-    auto lhs = theCurrContext->top_ptr();
-    theCurrContext->set_top(lhs->bor(rhs));
-    ++theCurrContext->pc();
-}
-
-void bxor_handle()
-{
-    auto rhs = theCurrContext->pop_ptr();
-    auto lhs = theCurrContext->top_ptr();
-    theCurrContext->set_top(lhs->bxor(rhs));
-    ++theCurrContext->pc();
-}
-
-void band_handle()
-{
-    auto rhs = theCurrContext->pop_ptr();
-    auto lhs = theCurrContext->top_ptr();
-    theCurrContext->set_top(lhs->band(rhs));
-    ++theCurrContext->pc();
-}
-
-void bls_handle()
-{
-    auto rhs = theCurrContext->pop_ptr();
-    auto lhs = theCurrContext->top_ptr();
-    theCurrContext->set_top(lhs->bls(rhs));
-    ++theCurrContext->pc();
-}
-
-void brs_handle()
-{
-    auto rhs = theCurrContext->pop_ptr();
-    auto lhs = theCurrContext->top_ptr();
-    theCurrContext->set_top(lhs->brs(rhs));
-    ++theCurrContext->pc();
-}
-
 void index_handle()
 {
     auto obj = theCurrContext->pop_ptr();
@@ -696,10 +746,9 @@ void buildenum_handle()
 void buildlist_handle()
 {
     auto list = Allocator<Object>::alloc<ListObject>();
-    auto size = OPRAND(Size);
-    while (size--)
+    for (auto num = theCurrContext->code()->oprand_at(theCurrContext->pc()); num--;)
     {
-        list->append(theCurrContext->pop_ptr());
+        list->append(theCurrContext->pop_value());
     }
     theCurrContext->push(list);
     ++theCurrContext->pc();
@@ -708,11 +757,10 @@ void buildlist_handle()
 void builddict_handle()
 {
     auto dict = Allocator<Object>::alloc<DictObject>();
-    auto size = OPRAND(Size);
-    while (size--)
+    for (auto num = theCurrContext->code()->oprand_at(theCurrContext->pc()); num--;)
     {
         auto key = theCurrContext->pop_ptr();
-        dict->insert(key, theCurrContext->pop_ptr());
+        dict->insert(key, theCurrContext->pop_value());
     }
     theCurrContext->push(dict);
     ++theCurrContext->pc();
@@ -734,19 +782,21 @@ void buildclass_handle()
         if (auto base_cls = dynamic_cast<ClassObject *>(base))
         {
             auto &scope = base_cls->scope();
+            static const auto init = Atoms::intern("__init__");
             bool has_ctor = false;
-            for (auto &sym_addr : scope->symbols())
-            {
-                if (sym_addr.first == "__init__")
+            scope->symbols().for_each([&](Atom name, const Address &addr)
                 {
-                    bctors->append(sym_addr.second->ptr());
-                    has_ctor = true;
+                    if (name == init)
+                    {
+                        bctors->append(addr->value());
+                        has_ctor = true;
+                    }
+                    else
+                    {
+                        cls->scope()->create_symbol(name, addr->value());
+                    }
                 }
-                else
-                {
-                    cls->scope()->create_symbol(sym_addr.first, sym_addr.second->ptr());
-                }
-            }
+            );
             if (!has_ctor)
             {
                 bctors->append(nullptr);
@@ -757,7 +807,8 @@ void buildclass_handle()
             throw RuntimeError("each base of one class must be one class");
         }
     }
-    cls->scope()->create_symbol("bctors", bctors);
+    static const auto bctors_name = Atoms::intern("bctors");
+    cls->scope()->create_symbol(bctors_name, bctors);
 
     theCurrContext->push(cls);
     // declare members in the new scope of the class
@@ -766,86 +817,893 @@ void buildclass_handle()
 }
 }
 
-using OpHandle = void (*)();
+/**
+ * use direct-threaded dispatch (labels as values) if the compiler supports it,
+ *  or fall back to the portable switch-based dispatch
+*/
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(ANOLE_NO_THREADED_DISPATCH)
+    #define ANOLE_THREADED_DISPATCH
+#endif
 
-constexpr OpHandle theOpHandles[] =
+/**
+ * registers of the running frame (context, instructions, pc and stack)
+ *  live in locals of the dispatch loop
+ *
+ * pc is written back by SAVE_PC() before any operation which may throw
+ *  because RuntimeError locates the error by the pc of theCurrContext,
+ *  and all registers are written back before calls, returns
+ *  and other operations which may switch theCurrContext,
+ *  then they will be reloaded by LOAD_FRAME()
+ *
+ * native code compiled by Jit or Aot is entered after them,
+ *  at the beginning and after backward jumps,
+ *  and it may switch theCurrContext too
+*/
+void Context::execute()
 {
-    nullptr,
+    Executing executing;
+
+    Context *ctx;
+    const Instruction *ins;
+    Size size, pc;
+    Stack *stack;
+    Address loaded;
+
+  #define LOAD_FRAME()                          \
+    do {                                        \
+        ctx = theCurrContext.get();             \
+        ins = ctx->code_->instructions();       \
+        size = ctx->code_->size();              \
+        pc = ctx->pc_;                          \
+        stack = ctx->stack_.get();              \
+    } while (false)
+
+  #define SAVE_PC() (ctx->pc_ = pc)
+
+  #define ENTER_NATIVE()                                        \
+    do {                                                        \
+        if (!Jit::enabled() && !Aot::loaded())                  \
+        {                                                       \
+            break;                                              \
+        }                                                       \
+        if (auto entry = ctx->code_->native_entry(pc))          \
+        {                                                       \
+            SAVE_PC();                                          \
+            Jit::run(ctx, entry);                               \
+            LOAD_FRAME();                                       \
+        }                                                       \
+        else if (auto entry = ctx->code_->aot_entry(pc))        \
+        {                                                       \
+            SAVE_PC();                                          \
+            Aot::run(ctx, entry);                               \
+            LOAD_FRAME();                                       \
+        }                                                       \
+    } while (false)
+
+  #define CALL_HANDLE(HANDLE)                   \
+    do {                                        \
+        SAVE_PC();                              \
+        op_handles::HANDLE();                   \
+        LOAD_FRAME();                           \
+        ENTER_NATIVE();                         \
+    } while (false)
+
+  // handlers which don't switch the context only move the pc
+  #define RUN_HANDLE(HANDLE)                    \
+    do {                                        \
+        SAVE_PC();                              \
+        op_handles::HANDLE();                   \
+        pc = ctx->pc_;                          \
+    } while (false)
+
+  #define OPRAND_AT() (ins[pc].oprand)
+
+  #ifdef ANOLE_THREADED_DISPATCH
+    static void *const targets[] =
+    {
+        &&TARGET_PlaceHolder,
+
+        &&TARGET_Pop,
+
+        &&TARGET_Import,
+        &&TARGET_ImportPath,
+        &&TARGET_ImportAll,
+        &&TARGET_ImportPart,
+
+        &&TARGET_Load,
+        &&TARGET_LoadConst,
+        &&TARGET_LoadMember,
+        &&TARGET_Store,
+        &&TARGET_StoreRef,
+        &&TARGET_StoreLocal,
+
+        &&TARGET_LoadLocal,
+        &&TARGET_LoadUpvalue,
+        &&TARGET_StoreSlot,
+        &&TARGET_StoreRefSlot,
+
+        &&TARGET_NewScope,
+        &&TARGET_EndScope,
+
+        &&TARGET_CallAc,
+        &&TARGET_Call,
+        &&TARGET_FastCall,
+        &&TARGET_TailCall,
+        &&TARGET_FastTailCall,
+        &&TARGET_Return,
+        &&TARGET_ReturnNone,
+        &&TARGET_Jump,
+        &&TARGET_JumpIf,
+        &&TARGET_JumpIfNot,
+        &&TARGET_Match,
+
+        &&TARGET_AddPrefixOp,
+        &&TARGET_AddInfixOp,
+
+        &&TARGET_Pack,
+        &&TARGET_Unpack,
+
+        &&TARGET_LambdaDecl,
+        &&TARGET_ThunkDecl,
+        &&TARGET_ThunkOver,
+
+        &&TARGET_Neg,
+        &&TARGET_Add,
+        &&TARGET_Sub,
+        &&TARGET_Mul,
+        &&TARGET_Div,
+        &&TARGET_Mod,
+
+        &&TARGET_Is,
+        &&TARGET_CEQ,
+        &&TARGET_CNE,
+        &&TARGET_CLT,
+        &&TARGET_CLE,
+
+        &&TARGET_BNeg,
+        &&TARGET_BOr,
+        &&TARGET_BXor,
+        &&TARGET_BAnd,
+        &&TARGET_BLS,
+        &&TARGET_BRS,
+
+        &&TARGET_Index,
+
+        &&TARGET_BuildEnum,
+        &&TARGET_BuildList,
+        &&TARGET_BuildDict,
+        &&TARGET_CopyConst,
+        &&TARGET_BuildClass,
+
+        &&TARGET_LoadLoadAdd,
+        &&TARGET_LoadConstAdd,
+        &&TARGET_LoadConstSub,
+        &&TARGET_LoadStorePop,
+        &&TARGET_StorePop,
+        &&TARGET_CEQJumpIfNot,
+        &&TARGET_CNEJumpIfNot,
+        &&TARGET_CLTJumpIfNot,
+        &&TARGET_CLEJumpIfNot,
+        &&TARGET_CallMethod,
+
+        &&TARGET_AddIntInt,
+        &&TARGET_SubIntInt,
+        &&TARGET_MulIntInt,
+        &&TARGET_CEQIntInt,
+        &&TARGET_CNEIntInt,
+        &&TARGET_CLTIntInt,
+        &&TARGET_CLEIntInt,
+        &&TARGET_AddFloatFloat,
+        &&TARGET_SubFloatFloat,
+        &&TARGET_MulFloatFloat,
+        &&TARGET_DivFloatFloat,
+        &&TARGET_CLTFloatFloat,
+        &&TARGET_CLEFloatFloat,
+        &&TARGET_CEQIntIntJumpIfNot,
+        &&TARGET_CNEIntIntJumpIfNot,
+        &&TARGET_CLTIntIntJumpIfNot,
+        &&TARGET_CLEIntIntJumpIfNot,
+        &&TARGET_LoadBuiltin,
+        &&TARGET_LoadGlobal,
+    };
+
+    #define TARGET(OP) TARGET_##OP:
+
+    #ifdef _DEBUG
+      #define DISPATCH() goto dispatch
+    #else
+      #define DISPATCH()                                                \
+        do {                                                            \
+            if (pc < size)                                              \
+            {                                                           \
+                goto *targets[static_cast<uint8_t>(ins[pc].opcode)];    \
+            }                                                           \
+            goto exit;                                                  \
+        } while (false)
+    #endif
+  #else
+    #define TARGET(OP) case Opcode::OP:
+    #define DISPATCH() goto dispatch
+  #endif
+
+  #define BINARY_OPERATION(OP)                  \
+    {                                           \
+        SAVE_PC();                              \
+        auto rhs = ctx->pop_value();            \
+        auto lhs = ctx->top_value();            \
+        ctx->set_top(lhs.OP(rhs));              \
+        ++pc;                                   \
+        DISPATCH();                             \
+    }
 
-    &op_handles::pop_handle,
+  #define QUICKENABLE_OPERATION(OP)             \
+    {                                           \
+        SAVE_PC();                              \
+        auto rhs = ctx->pop_value();            \
+        auto lhs = ctx->top_value();            \
+        quicken(*ctx->code_, pc, lhs, rhs);     \
+        ctx->set_top(lhs.OP(rhs));              \
+        ++pc;                                   \
+        DISPATCH();                             \
+    }
 
-    &op_handles::import_handle,
-    &op_handles::importpath_handle,
-    &op_handles::importall_handle,
-    &op_handles::importpart_handle,
+  #define COMPARE_JUMP_IF_NOT(OP)               \
+    {                                           \
+        SAVE_PC();                              \
+        auto rhs = ctx->pop_value();            \
+        auto lhs = ctx->pop_value();            \
+        quicken(*ctx->code_, pc, lhs, rhs);     \
+        auto res = lhs.OP(rhs);                 \
+        ctx->pc_ = pc + 1;                      \
+        if (!res.to_bool())                     \
+        {                                       \
+            pc = ins[pc + 1].oprand;            \
+        }                                       \
+        else                                    \
+        {                                       \
+            pc += 2;                            \
+        }                                       \
+        DISPATCH();                             \
+    }
 
-    &op_handles::load_handle,
-    &op_handles::loadconst_handle,
-    &op_handles::loadmember_handle,
-    &op_handles::store_handle,
-    &op_handles::storeref_handle,
-    &op_handles::storelocal_handle,
+  /**
+   * quickened instructions check types of oprands on the stack,
+   *  they are rewritten back and dispatched again as generic ones
+   *  if the types change
+  */
+  #define QUICKENED_OPERATION(TYPE, RESULT)     \
+    {                                           \
+        auto rhs = stack->back().value();       \
+        auto lhs = (stack->end() - 2)->value(); \
+        if (!lhs.is_##TYPE()                    \
+            || !rhs.is_##TYPE())                \
+        {                                       \
+            ctx->code_->unquicken(pc);          \
+            DISPATCH();                         \
+        }                                       \
+        stack->pop_back();                      \
+        stack->back() = Slot(RESULT);           \
+        ++pc;                                   \
+        DISPATCH();                             \
+    }
 
-    &op_handles::newscope_handle,
-    &op_handles::endscope_handle,
+  #define QUICKENED_COMPARE_JUMP_IF_NOT(OP)     \
+    {                                           \
+        auto rhs = stack->back().value();       \
+        auto lhs = (stack->end() - 2)->value(); \
+        if (!lhs.is_integer()                   \
+            || !rhs.is_integer())               \
+        {                                       \
+            ctx->code_->unquicken(pc);          \
+            DISPATCH();                         \
+        }                                       \
+        stack->erase(stack->end() - 2,          \
+            stack->end());                      \
+        pc = lhs.as_integer() OP                \
+            rhs.as_integer()                    \
+            ? pc + 2 : ins[pc + 1].oprand;      \
+        DISPATCH();                             \
+    }
 
-    &op_handles::callac_handle,
-    &op_handles::call_handle,
-    &op_handles::fastcall_handle,
-    &op_handles::return_handle,
-    &op_handles::returnnone_handle,
-    &op_handles::jump_handle,
-    &op_handles::jumpif_handle,
-    &op_handles::jumpifnot_handle,
-    &op_handles::match_handle,
+    LOAD_FRAME();
+    ENTER_NATIVE();
 
-    &op_handles::addprefixop_handle,
-    &op_handles::addinfixop_handle,
+  #if defined(ANOLE_THREADED_DISPATCH) && !defined(_DEBUG)
+    DISPATCH();
+  #else
+  dispatch:
+    if (pc >= size)
+    {
+        goto exit;
+    }
 
-    &op_handles::pack_handle,
-    &op_handles::unpack_handle,
+    #ifdef _DEBUG
+    std::cerr << "run at: " << ctx->code_->from() << ":" << pc << std::endl;
+    #endif
+  #endif
 
-    &op_handles::lambdadecl_handle,
-    &op_handles::thunkdecl_handle,
-    &op_handles::thunkover_handle,
+  #ifdef ANOLE_THREADED_DISPATCH
+    goto *targets[static_cast<uint8_t>(ins[pc].opcode)];
+  #else
+    switch (ins[pc].opcode)
+  #endif
+    {
+    // placeholders are never filled if they are out of loops like `break`
+    TARGET(PlaceHolder)
+        ++pc;
+        DISPATCH();
+
+    TARGET(Pop)
+        ctx->pop(OPRAND_AT());
+        ++pc;
+        DISPATCH();
+
+    TARGET(Import)
+        CALL_HANDLE(import_handle);
+        DISPATCH();
+
+    TARGET(ImportPath)
+        CALL_HANDLE(importpath_handle);
+        DISPATCH();
+
+    TARGET(ImportAll)
+        CALL_HANDLE(importall_handle);
+        DISPATCH();
+
+    TARGET(ImportPart)
+        CALL_HANDLE(importpart_handle);
+        DISPATCH();
+
+    TARGET(Load)
+        if (!variable_has_slot(OPRAND_AT()))
+        {
+            auto name = ctx->code_->atom_at(OPRAND_AT());
+            loaded = ctx->scope_->load_symbol(name);
+            quicken_load(ctx, pc, name, loaded);
+            goto push_loaded;
+        }
+    TARGET(LoadUpvalue)
+    load:
+        loaded = load_variable(ctx, OPRAND_AT());
+    push_loaded:
+    {
+        auto addr = std::move(loaded);
 
-    &op_handles::neg_handle,
-    &op_handles::add_handle,
-    &op_handles::sub_handle,
-    &op_handles::mul_handle,
-    &op_handles::div_handle,
-    &op_handles::mod_handle,
+        auto obj = addr->value().heap_object();
+        if (obj == nullptr || !obj->is<ObjectType::Thunk>())
+        {
+            stack->push_back(std::move(addr));
+            ++pc;
+            DISPATCH();
+        }
 
-    &op_handles::is_handle,
-    &op_handles::ceq_handle,
-    &op_handles::cne_handle,
-    &op_handles::clt_handle,
-    &op_handles::cle_handle,
+        auto thunk = reinterpret_cast<ThunkObject *>(obj);
+        if (thunk->computed())
+        {
+            stack->push_back(thunk->result());
+            ++pc;
+            DISPATCH();
+        }
 
-    &op_handles::bneg_handle,
-    &op_handles::bor_handle,
-    &op_handles::bxor_handle,
-    &op_handles::band_handle,
-    &op_handles::bls_handle,
-    &op_handles::brs_handle,
+        // compute the thunk in a new context
+        stack->push_back(std::move(addr));
+        SAVE_PC();
+        theCurrContext = make_pooled<Context>(
+            theCurrContext, thunk->scope(), thunk->code(), thunk->base()
+        );
+        LOAD_FRAME();
+        DISPATCH();
+    }
 
-    &op_handles::index_handle,
+    TARGET(LoadBuiltin)
+    {
+        auto name = ctx->code_->atom_at(OPRAND_AT());
+        if (Scope::definitions(name))
+        {
+            ctx->code_->unquicken(pc);
+            DISPATCH();
+        }
+        ctx->push(BuiltInFunctionObject::load_built_in_function(name));
+        ++pc;
+        DISPATCH();
+    }
 
-    &op_handles::buildenum_handle,
-    &op_handles::buildlist_handle,
-    &op_handles::builddict_handle,
-    &op_handles::buildclass_handle,
-};
+    TARGET(LoadGlobal)
+        if (Scope::definitions(ctx->code_->atom_at(OPRAND_AT())) != 1)
+        {
+            ctx->code_->unquicken(pc);
+            DISPATCH();
+        }
+        loaded = ctx->code_->global_cell(pc);
+        goto push_loaded;
 
-void Context::execute()
-{
-    while (theCurrContext->pc() < theCurrContext->code()->size())
+    TARGET(LoadConst)
+        ctx->push(ctx->code_->load_const(OPRAND_AT()));
+        ++pc;
+        DISPATCH();
+
+    TARGET(LoadMember)
+    {
+        SAVE_PC();
+        auto address = load_member(ctx, ctx->pop_ptr(), OPRAND_AT());
+        stack->push_back(std::move(address));
+        ++pc;
+        DISPATCH();
+    }
+
+    TARGET(Store)
     {
-      #ifdef _DEBUG
-        std::cerr << "run at: " << theCurrContext->code()->from() << ":" << theCurrContext->pc() << std::endl;
-      #endif
+        SAVE_PC();
+        auto addr = ctx->pop_address();
+        addr->bind(ctx->pop_value());
+        stack->push_back(std::move(addr));
+        ++pc;
+        DISPATCH();
+    }
+
+    TARGET(StoreRef)
+        RUN_HANDLE(storeref_handle);
+        DISPATCH();
+
+    TARGET(StoreLocal)
+        RUN_HANDLE(storelocal_handle);
+        DISPATCH();
+
+    TARGET(LoadLocal)
+        if (auto addr = ctx->scope_->find_slot(variable_slot(OPRAND_AT())))
+        {
+            loaded = *addr;
+            goto push_loaded;
+        }
+        goto load;
 
-        theOpHandles[static_cast<uint8_t>(theCurrContext->opcode())]();
+    TARGET(StoreSlot)
+    {
+        SAVE_PC();
+        auto oprand = OPRAND_AT();
+        auto slot = variable_slot(oprand);
+        if (auto addr = ctx->scope_->find_slot(slot))
+        {
+            (*addr)->bind(ctx->pop_value());
+        }
+        else
+        {
+            auto created = ctx->scope_->create_symbol(ctx->code_->atom_at(variable_name(oprand)));
+            created->bind(ctx->pop_value());
+            ctx->scope_->set_slot(slot, std::move(created));
+        }
+        ++pc;
+        DISPATCH();
     }
+
+    TARGET(StoreRefSlot)
+        RUN_HANDLE(storerefslot_handle);
+        DISPATCH();
+
+    TARGET(NewScope)
+        ctx->scope_ = make_pooled<Scope>(ctx->scope_);
+        ++pc;
+        DISPATCH();
+
+    TARGET(EndScope)
+        ctx->scope_ = ctx->scope_->pre();
+        ++pc;
+        DISPATCH();
+
+    TARGET(CallAc)
+        ctx->set_call_anchor();
+        ++pc;
+        DISPATCH();
+
+    TARGET(Call)
+        CALL_HANDLE(call_handle);
+        DISPATCH();
+
+    TARGET(FastCall)
+        CALL_HANDLE(fastcall_handle);
+        DISPATCH();
+
+    TARGET(TailCall)
+        CALL_HANDLE(tailcall_handle);
+        DISPATCH();
+
+    TARGET(FastTailCall)
+        CALL_HANDLE(fasttailcall_handle);
+        DISPATCH();
+
+    TARGET(Return)
+        CALL_HANDLE(return_handle);
+        DISPATCH();
+
+    TARGET(ReturnNone)
+        CALL_HANDLE(returnnone_handle);
+        DISPATCH();
+
+    /**
+     * backward jumps of loops are safepoints like returns,
+     *  and they count loops for Jit
+    */
+    TARGET(Jump)
+        if (OPRAND_AT() < pc)
+        {
+            if (Collector::due())
+            {
+                SAVE_PC();
+                Collector::try_gc();
+            }
+            if (Jit::enabled())
+            {
+                SAVE_PC();
+                Jit::count_loop(*ctx->code_, OPRAND_AT(), pc + 1);
+            }
+            pc = OPRAND_AT();
+            ENTER_NATIVE();
+            DISPATCH();
+        }
+        pc = OPRAND_AT();
+        DISPATCH();
+
+    TARGET(JumpIf)
+        SAVE_PC();
+        if (ctx->pop_value().to_bool())
+        {
+            if (OPRAND_AT() < pc)
+            {
+                Collector::try_gc();
+            }
+            pc = OPRAND_AT();
+        }
+        else
+        {
+            ++pc;
+        }
+        DISPATCH();
+
+    TARGET(JumpIfNot)
+        SAVE_PC();
+        if (!ctx->pop_value().to_bool())
+        {
+            pc = OPRAND_AT();
+        }
+        else
+        {
+            ++pc;
+        }
+        DISPATCH();
+
+    TARGET(Match)
+    {
+        SAVE_PC();
+        auto key = ctx->pop_value();
+        if (ctx->top_value().ceq(key).to_bool())
+        {
+            ctx->pop();
+            pc = OPRAND_AT();
+        }
+        else
+        {
+            ++pc;
+        }
+        DISPATCH();
+    }
+
+    TARGET(AddPrefixOp)
+        CALL_HANDLE(addprefixop_handle);
+        DISPATCH();
+
+    TARGET(AddInfixOp)
+        CALL_HANDLE(addinfixop_handle);
+        DISPATCH();
+
+    TARGET(Pack)
+        RUN_HANDLE(pack_handle);
+        DISPATCH();
+
+    TARGET(Unpack)
+    {
+        SAVE_PC();
+        auto n = OPRAND_AT();
+
+        if (!ctx->top_ptr()->is<ObjectType::List>())
+        {
+            throw RuntimeError("expect list expr");
+        }
+
+        auto l = ctx->top_ptr<ListObject>();
+        if (n && l->objects().size() != n)
+        {
+            throw RuntimeError(
+                "expect " + std::to_string(n) +
+                " but given " + std::to_string(l->objects().size())
+            );
+        }
+
+        ctx->pop();
+        for (auto it = l->objects().rbegin();
+            it != l->objects().rend(); ++it)
+        {
+            stack->push_back(*it);
+        }
+        ++pc;
+        DISPATCH();
+    }
+
+    TARGET(LambdaDecl)
+        RUN_HANDLE(lambdadecl_handle);
+        DISPATCH();
+
+    TARGET(ThunkDecl)
+        RUN_HANDLE(thunkdecl_handle);
+        DISPATCH();
+
+    TARGET(ThunkOver)
+        CALL_HANDLE(thunkover_handle);
+        DISPATCH();
+
+    TARGET(Neg)
+        SAVE_PC();
+        ctx->set_top(ctx->top_value().neg());
+        ++pc;
+        DISPATCH();
+
+    TARGET(Add)
+        QUICKENABLE_OPERATION(add)
+
+    TARGET(Sub)
+        QUICKENABLE_OPERATION(sub)
+
+    TARGET(Mul)
+        QUICKENABLE_OPERATION(mul)
+
+    TARGET(Div)
+        QUICKENABLE_OPERATION(div)
+
+    TARGET(Mod)
+        BINARY_OPERATION(mod)
+
+    TARGET(Is)
+    {
+        SAVE_PC();
+        auto rhs = ctx->pop_value();
+        ctx->set_top(Value::boolean(ctx->top_value().is(rhs)));
+        ++pc;
+        DISPATCH();
+    }
+
+    TARGET(CEQ)
+        QUICKENABLE_OPERATION(ceq)
+
+    TARGET(CNE)
+        QUICKENABLE_OPERATION(cne)
+
+    TARGET(CLT)
+        QUICKENABLE_OPERATION(clt)
+
+    TARGET(CLE)
+        QUICKENABLE_OPERATION(cle)
+
+    TARGET(BNeg)
+        SAVE_PC();
+        ctx->set_top(ctx->top_value().bneg());
+        ++pc;
+        DISPATCH();
+
+    TARGET(BOr)
+        BINARY_OPERATION(bor)
+
+    TARGET(BXor)
+        BINARY_OPERATION(bxor)
+
+    TARGET(BAnd)
+        BINARY_OPERATION(band)
+
+    TARGET(BLS)
+        BINARY_OPERATION(bls)
+
+    TARGET(BRS)
+        BINARY_OPERATION(brs)
+
+    TARGET(Index)
+        RUN_HANDLE(index_handle);
+        DISPATCH();
+
+    TARGET(BuildEnum)
+        CALL_HANDLE(buildenum_handle);
+        DISPATCH();
+
+    TARGET(BuildList)
+        RUN_HANDLE(buildlist_handle);
+        DISPATCH();
+
+    TARGET(BuildDict)
+        RUN_HANDLE(builddict_handle);
+        DISPATCH();
+
+    TARGET(CopyConst)
+        SAVE_PC();
+        ctx->push(copy_const(ctx->code_->load_const(OPRAND_AT())));
+        ++pc;
+        DISPATCH();
+
+    TARGET(BuildClass)
+        CALL_HANDLE(buildclass_handle);
+        DISPATCH();
+
+    /**
+     * superinstructions set pc of the context to the instruction
+     *  in the sequence which may throw before executing it,
+     *  so that errors are located as before
+    */
+    TARGET(LoadLoadAdd)
+    {
+        auto lhs = load_variable(ctx, OPRAND_AT())->value();
+        auto rhs = load_variable(ctx, ins[pc + 1].oprand)->value();
+        if (!is_plain(lhs) || !is_plain(rhs))
+        {
+            goto load;
+        }
+        ctx->pc_ = pc + 2;
+        ctx->push(lhs.add(rhs));
+        pc += 3;
+        DISPATCH();
+    }
+
+    TARGET(LoadConstAdd)
+    {
+        auto lhs = load_variable(ctx, OPRAND_AT())->value();
+        if (!is_plain(lhs))
+        {
+            goto load;
+        }
+        ctx->pc_ = pc + 2;
+        ctx->push(lhs.add(ctx->code_->load_const(ins[pc + 1].oprand)));
+        pc += 3;
+        DISPATCH();
+    }
+
+    TARGET(LoadConstSub)
+    {
+        auto lhs = load_variable(ctx, OPRAND_AT())->value();
+        if (!is_plain(lhs))
+        {
+            goto load;
+        }
+        ctx->pc_ = pc + 2;
+        ctx->push(lhs.sub(ctx->code_->load_const(ins[pc + 1].oprand)));
+        pc += 3;
+        DISPATCH();
+    }
+
+    TARGET(LoadStorePop)
+    {
+        auto addr = load_variable(ctx, OPRAND_AT());
+        auto obj = addr->value().heap_object();
+        if (obj != nullptr && obj->is<ObjectType::Thunk>())
+        {
+            goto load;
+        }
+        ctx->pc_ = pc + 1;
+        addr->bind(ctx->pop_value());
+        pc += 3;
+        DISPATCH();
+    }
+
+    TARGET(StorePop)
+    {
+        SAVE_PC();
+        auto addr = ctx->pop_address();
+        addr->bind(ctx->pop_value());
+        pc += 2;
+        DISPATCH();
+    }
+
+    TARGET(CEQJumpIfNot)
+        COMPARE_JUMP_IF_NOT(ceq)
+
+    TARGET(CNEJumpIfNot)
+        COMPARE_JUMP_IF_NOT(cne)
+
+    TARGET(CLTJumpIfNot)
+        COMPARE_JUMP_IF_NOT(clt)
+
+    TARGET(CLEJumpIfNot)
+        COMPARE_JUMP_IF_NOT(cle)
+
+    TARGET(CallMethod)
+    {
+        SAVE_PC();
+        auto obj = ctx->pop_ptr();
+        if (auto method = find_native_method(ctx, obj, OPRAND_AT()))
+        {
+            // errors are located at the FastCall like bound methods
+            ctx->pc_ = ++pc;
+            (*method)(obj);
+            ++theCurrContext->pc();
+            LOAD_FRAME();
+            DISPATCH();
+        }
+        auto address = load_member(ctx, obj, OPRAND_AT());
+        stack->push_back(std::move(address));
+        if (ins[++pc].opcode == Opcode::FastTailCall)
+        {
+            CALL_HANDLE(fasttailcall_handle);
+        }
+        else
+        {
+            CALL_HANDLE(fastcall_handle);
+        }
+        DISPATCH();
+    }
+
+    TARGET(AddIntInt)
+        QUICKENED_OPERATION(integer, Value::integer(lhs.as_integer() + rhs.as_integer()))
+
+    TARGET(SubIntInt)
+        QUICKENED_OPERATION(integer, Value::integer(lhs.as_integer() - rhs.as_integer()))
+
+    // integers wrap around like the generic Mul
+    TARGET(MulIntInt)
+        QUICKENED_OPERATION(integer, Value::integer(
+            int64_t(uint64_t(lhs.as_integer()) * uint64_t(rhs.as_integer()))))
+
+    TARGET(CEQIntInt)
+        QUICKENED_OPERATION(integer, Value::boolean(lhs.as_integer() == rhs.as_integer()))
+
+    TARGET(CNEIntInt)
+        QUICKENED_OPERATION(integer, Value::boolean(lhs.as_integer() != rhs.as_integer()))
+
+    TARGET(CLTIntInt)
+        QUICKENED_OPERATION(integer, Value::boolean(lhs.as_integer() < rhs.as_integer()))
+
+    TARGET(CLEIntInt)
+        QUICKENED_OPERATION(integer, Value::boolean(lhs.as_integer() <= rhs.as_integer()))
+
+    TARGET(AddFloatFloat)
+        QUICKENED_OPERATION(float, Value::floating(lhs.as_float() + rhs.as_float()))
+
+    TARGET(SubFloatFloat)
+        QUICKENED_OPERATION(float, Value::floating(lhs.as_float() - rhs.as_float()))
+
+    TARGET(MulFloatFloat)
+        QUICKENED_OPERATION(float, Value::floating(lhs.as_float() * rhs.as_float()))
+
+    TARGET(DivFloatFloat)
+        QUICKENED_OPERATION(float, Value::floating(lhs.as_float() / rhs.as_float()))
+
+    TARGET(CLTFloatFloat)
+        QUICKENED_OPERATION(float, Value::boolean(lhs.as_float() < rhs.as_float()))
+
+    TARGET(CLEFloatFloat)
+        QUICKENED_OPERATION(float, Value::boolean(lhs.as_float() <= rhs.as_float()))
+
+    TARGET(CEQIntIntJumpIfNot)
+        QUICKENED_COMPARE_JUMP_IF_NOT(==)
+
+    TARGET(CNEIntIntJumpIfNot)
+        QUICKENED_COMPARE_JUMP_IF_NOT(!=)
+
+    TARGET(CLTIntIntJumpIfNot)
+        QUICKENED_COMPARE_JUMP_IF_NOT(<)
+
+    TARGET(CLEIntIntJumpIfNot)
+        QUICKENED_COMPARE_JUMP_IF_NOT(<=)
+    }
+
+  exit:
+    SAVE_PC();
+
+  #undef LOAD_FRAME
+  #undef SAVE_PC
+  #undef CALL_HANDLE
+  #undef RUN_HANDLE
+  #undef ENTER_NATIVE
+  #undef OPRAND_AT
+  #undef TARGET
+  #undef DISPATCH
+  #undef BINARY_OPERATION
+  #undef COMPARE_JUMP_IF_NOT
+  #undef QUICKENABLE_OPERATION
+  #undef QUICKENED_OPERATION
+  #undef QUICKENED_COMPARE_JUMP_IF_NOT
 }
 }
@@ -8,10 +8,8 @@
 #include "../error.hpp"
 #include "../compiler/instruction.hpp"
 
-#include <any>
 #include <map>
-#include <list>
-#include <stack>
+#include <vector>
 #include <filesystem>
 
 namespace anole
@@ -23,19 +21,85 @@ class Context;
 extern SPtr<std::filesystem::path> theWorkingPath;
 extern SPtr<Context> theCurrContext;
 
-// Context should be contructed by make_shared
+// Context should be contructed by make_shared, or make_pooled for calls
 class Context
 {
     friend class Collector;
 
   public:
-    using Stack = std::list<Address>;
+    /**
+     * one slot of the operand stack holds a temporary value directly
+     *  or an address if it references to a variable,
+     *  so that the variable is only created when it is needed
+    */
+    class Slot
+    {
+      public:
+        Slot(Value value) noexcept
+          : value_(value)
+        {
+            // ...
+        }
+
+        Slot(Address addr) noexcept
+          : value_(), addr_(std::move(addr))
+        {
+            // ...
+        }
+
+        Value value() const noexcept
+        {
+            return addr_ ? addr_->value() : value_;
+        }
+
+        // the temporary immediate value will be boxed only once
+        Object *ptr()
+        {
+            if (addr_)
+            {
+                return addr_->ptr();
+            }
+            if (!value_.is_object())
+            {
+                value_ = value_.box();
+            }
+            return value_.as_object();
+        }
+
+        bool has_address() const noexcept
+        {
+            return bool(addr_);
+        }
+
+        /**
+         * create a variable for the temporary value
+         *  if the slot doesn't reference to any variable
+        */
+        Address &address()
+        {
+            if (!addr_)
+            {
+                addr_ = make_pooled<Variable>(value_);
+            }
+            return addr_;
+        }
+
+        void trace(Visitor &visitor);
+
+      private:
+        Value value_;
+        Address addr_;
+    };
+
+    using Stack = std::vector<Slot>;
 
   public:
     static void set_args(int argc, char *argv[], int start);
     static const std::vector<char *> &get_args();
 
     static void execute();
+    // how many calls of execute are running, nested by native code
+    static Size executing() noexcept;
 
   public:
     // this for resume from ContObject
@@ -46,34 +110,63 @@ class Context
     Context(SPtr<Code> code);
     // ctor for callable objects
     Context(SPtr<Context> pre, SPtr<Scope> scope, SPtr<Code> code, Size pc = 0);
+    ~Context();
 
+    // accessors used by helpers of native code are inline, see jit.hpp
     SPtr<Context> &pre_context();
-    SPtr<Scope> &scope();
-    SPtr<Code> &code();
-    Size &pc() noexcept;
+    SPtr<Scope> &scope() noexcept
+    {
+        return scope_;
+    }
+    SPtr<Code> &code() noexcept
+    {
+        return code_;
+    }
+    Size &pc() noexcept
+    {
+        return pc_;
+    }
 
     const Opcode &opcode() const;
-    const std::any &oprand() const;
+    const Oprand &oprand() const;
 
-    void push(Object *ptr);
-    void push(Address addr);
+    void push(Value value)
+    {
+        stack_->emplace_back(value);
+    }
+    void push(Address addr)
+    {
+        stack_->emplace_back(std::move(addr));
+    }
 
     template<typename R = Object>
     R *top_ptr()
     {
-        if (stack_->back()->ptr() == nullptr)
+        auto ptr = stack_->back().ptr();
+        if (ptr == nullptr)
+        {
+            throw RuntimeError(unbound_error(top_address()));
+        }
+        return reinterpret_cast<R *>(ptr);
+    }
+    Value top_value()
+    {
+        auto value = stack_->back().value();
+        if (value.is_null())
         {
-            throw RuntimeError(
-                "var named " +
-                stack_->back()->called_name() +
-                " doesn't reference to any object"
-            );
+            throw RuntimeError(unbound_error(top_address()));
         }
-        return reinterpret_cast<R *>(stack_->back()->ptr());
+        return value;
     }
-    const Address &top_address() const;
+    const Address &top_address();
+    String name_of(const Address &addr);
+    // the error of the unbound variable, with its name if it's found
+    String unbound_error(const Address &addr);
     void set_top(Address addr);
-    void set_top(Object *ptr);
+    void set_top(Value value)
+    {
+        stack_->back() = Slot(value);
+    }
     void pop(Size num = 1);
     template<typename R = Object>
     R *pop_ptr()
@@ -82,15 +175,30 @@ class Context
         stack_->pop_back();
         return reinterpret_cast<R *>(ptr);
     }
+    Value pop_value()
+    {
+        auto value = top_value();
+        stack_->pop_back();
+        return value;
+    }
     Address pop_address();
 
     Size size() const;
-    Stack *get_stack();
+    Stack *get_stack() noexcept
+    {
+        return stack_.get();
+    }
     const std::filesystem::path &code_path() const;
 
     void set_call_anchor();
     Size get_call_args_num();
 
+    /**
+     * visit the context above, the scope and objects on the stack,
+     *  the stack is left to the context above if they share it
+    */
+    void trace(Visitor &visitor);
+
   private:
     SPtr<Context> pre_context_;
     SPtr<Scope> scope_;
@@ -98,7 +206,10 @@ class Context
     Size pc_;
     SPtr<Stack> stack_;
 
-    std::stack<Size> call_anchors_;
+    std::vector<Size> call_anchors_;
+    uint32_t mark_ = 0;
+    // the index in traced contexts plus one, see Collector
+    uint32_t traced_ = 0;
 };
 }
 
@@ -0,0 +1,78 @@
+#ifndef __ANOLE_RUNTIME_HANDLES_HPP__
+#define __ANOLE_RUNTIME_HANDLES_HPP__
+
+#include "scope.hpp"
+#include "context.hpp"
+#include "../objects/object.hpp"
+
+namespace anole
+{
+/**
+ * handlers of instructions out of the dispatch loop, see context.cpp,
+ *  native code of Jit calls them too so that both do the same
+*/
+namespace op_handles
+{
+void import_handle();
+void importpath_handle();
+void importall_handle();
+void importpart_handle();
+
+void storeref_handle();
+void storelocal_handle();
+void storerefslot_handle();
+
+void call_handle();
+void fastcall_handle();
+void tailcall_handle();
+void fasttailcall_handle();
+void return_handle();
+void returnnone_handle();
+
+void addprefixop_handle();
+void addinfixop_handle();
+
+void pack_handle();
+void lambdadecl_handle();
+void thunkdecl_handle();
+void thunkover_handle();
+
+void index_handle();
+void buildenum_handle();
+void buildlist_handle();
+void builddict_handle();
+void buildclass_handle();
+} // namespace op_handles
+
+/**
+ * values of variables loaded by superinstructions must be plain,
+ *  which means they are bound and not thunks,
+ *  or the generic Load will be executed instead
+*/
+inline bool is_plain(Value value)
+{
+    if (value.is_object())
+    {
+        auto obj = value.as_object();
+        return obj != nullptr && !obj->is<ObjectType::Thunk>();
+    }
+    return true;
+}
+
+// the slot of the variable if it's resolved and set, or nullptr
+inline Address *find_variable(Context *ctx, Oprand oprand)
+{
+    if (!variable_has_slot(oprand))
+    {
+        return nullptr;
+    }
+    auto scope = ctx->scope().get();
+    for (auto depth = variable_depth(oprand); depth-- && scope;)
+    {
+        scope = scope->lexical_pre();
+    }
+    return scope ? scope->find_slot(variable_slot(oprand)) : nullptr;
+}
+} // namespace anole
+
+#endif
@@ -0,0 +1,479 @@
+#include "runtime.hpp"
+
+#include "../objects/objects.hpp"
+
+#include <new>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <sys/mman.h>
+
+namespace anole
+{
+namespace
+{
+// cells are aligned to 8 bytes, classes are finer for small objects
+constexpr Size kClassSizes[] = {
+    16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256
+};
+constexpr Size kClassCount = sizeof(kClassSizes) / sizeof(*kClassSizes);
+// pages of large objects only hold one object
+constexpr Size kLargeClass = kClassCount;
+constexpr Size kMaxCells = Heap::kPageSize / 16;
+
+static_assert(kClassSizes[kClassCount - 1] == Heap::kMaxCellSize);
+
+/**
+ * each page begins with its header,
+ *  used cells are recorded by bits of the header,
+ *  and free cells are linked by their first words
+*/
+struct Page
+{
+    Size size_class;
+    Size cell_size;
+    Size cells;
+    Size live;
+    // cells from the bump are never used
+    Size bump;
+    void *free;
+    // the page is current or available in its size class
+    bool listed;
+    bool evacuated;
+    Size mapped;
+    uint64_t used[kMaxCells / 64];
+};
+
+constexpr Size kHeaderSize = (sizeof(Page) + 15) & ~Size(15);
+
+struct SizeClass
+{
+    Page *current = nullptr;
+    // pages with free cells
+    std::vector<Page *> available;
+};
+
+SizeClass *get_size_classes()
+{
+    static SizeClass size_classes[kClassCount];
+    return size_classes;
+}
+
+std::vector<Page *> &get_pages()
+{
+    static std::vector<Page *> pages;
+    return pages;
+}
+
+/**
+ * pages may be swept by another thread,
+ *  so lists of pages and free lists of classes are locked,
+ *  but cells of current pages are taken without the lock
+*/
+std::mutex &get_lock()
+{
+    static std::mutex lock;
+    return lock;
+}
+
+// pages may be returned by the sweeping thread
+std::atomic<Size> &get_mapped_bytes()
+{
+    static std::atomic<Size> mapped_bytes{0};
+    return mapped_bytes;
+}
+
+Size size_class(Size size) noexcept
+{
+    if (size <= 64)
+    {
+        return size <= 16 ? 0 : (size + 7) / 8 - 2;
+    }
+    else if (size <= 128)
+    {
+        return (size + 15) / 16 + 2;
+    }
+    return (size + 31) / 32 + 6;
+}
+
+char *cell_of(Page *page, Size ind) noexcept
+{
+    return reinterpret_cast<char *>(page) + kHeaderSize + ind * page->cell_size;
+}
+
+Page *page_of(const void *ptr) noexcept
+{
+    return reinterpret_cast<Page *>(
+        reinterpret_cast<uintptr_t>(ptr) & ~uintptr_t(Heap::kPageSize - 1)
+    );
+}
+
+// map the memory aligned to the page size by trimming the extra
+Page *map_page(Size bytes)
+{
+    auto extra = Heap::kPageSize;
+    auto mem = mmap(nullptr, bytes + extra, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0
+    );
+    if (mem == MAP_FAILED)
+    {
+        throw std::bad_alloc();
+    }
+
+    auto begin = reinterpret_cast<uintptr_t>(mem);
+    auto aligned = (begin + extra - 1) & ~uintptr_t(extra - 1);
+    if (aligned > begin)
+    {
+        munmap(mem, aligned - begin);
+    }
+    if (auto tail = begin + extra - aligned)
+    {
+        munmap(reinterpret_cast<void *>(aligned + bytes), tail);
+    }
+
+    auto page = reinterpret_cast<Page *>(aligned);
+    page->mapped = bytes;
+    get_mapped_bytes().fetch_add(bytes, std::memory_order_relaxed);
+    return page;
+}
+
+Page *new_page(Size size_class, Size cell_size)
+{
+    auto bytes = size_class == kLargeClass
+        ? (kHeaderSize + cell_size + 4095) & ~Size(4095)
+        : Heap::kPageSize
+    ;
+    auto page = map_page(bytes);
+    page->size_class = size_class;
+    page->cell_size = cell_size;
+    page->cells = size_class == kLargeClass ? 1 : (bytes - kHeaderSize) / cell_size;
+    page->live = 0;
+    page->bump = 0;
+    page->free = nullptr;
+    page->listed = size_class != kLargeClass;
+    page->evacuated = false;
+    // mapped memory is zeroed, so are bits of used cells
+
+    std::lock_guard<std::mutex> guard(get_lock());
+    get_pages().push_back(page);
+    return page;
+}
+
+void release(Page *page)
+{
+    get_mapped_bytes().fetch_sub(page->mapped, std::memory_order_relaxed);
+    munmap(page, page->mapped);
+}
+
+bool is_full(Page *page) noexcept
+{
+    return page->free == nullptr && page->bump == page->cells;
+}
+
+void *take(Page *page) noexcept
+{
+    Size ind;
+    if (page->free)
+    {
+        auto cell = page->free;
+        page->free = *reinterpret_cast<void **>(cell);
+        ind = (reinterpret_cast<char *>(cell) - cell_of(page, 0)) / page->cell_size;
+    }
+    else
+    {
+        ind = page->bump++;
+    }
+    page->used[ind / 64] |= uint64_t(1) << (ind % 64);
+    ++page->live;
+    return cell_of(page, ind);
+}
+
+void put(Page *page, Size ind) noexcept
+{
+    auto cell = cell_of(page, ind);
+    page->used[ind / 64] &= ~(uint64_t(1) << (ind % 64));
+    *reinterpret_cast<void **>(cell) = page->free;
+    page->free = cell;
+    --page->live;
+}
+}
+
+void *Heap::allocate(Size size)
+{
+    if (size > kMaxCellSize)
+    {
+        return take(new_page(kLargeClass, size));
+    }
+
+    auto ind = size_class(size);
+    auto &klass = get_size_classes()[ind];
+    auto page = klass.current;
+    if (page == nullptr || is_full(page))
+    {
+        if (page)
+        {
+            page->listed = false;
+        }
+        std::unique_lock<std::mutex> guard(get_lock());
+        if (klass.available.empty())
+        {
+            guard.unlock();
+            page = new_page(ind, kClassSizes[ind]);
+        }
+        else
+        {
+            page = klass.available.back();
+            klass.available.pop_back();
+        }
+        klass.current = page;
+    }
+    return take(page);
+}
+
+void Heap::deallocate(void *ptr)
+{
+    auto page = page_of(ptr);
+    put(page, (reinterpret_cast<char *>(ptr) - cell_of(page, 0)) / page->cell_size);
+
+    std::lock_guard<std::mutex> guard(get_lock());
+    if (page->size_class == kLargeClass)
+    {
+        auto &pages = get_pages();
+        pages.erase(std::find(pages.begin(), pages.end(), page));
+        release(page);
+    }
+    else if (!page->listed)
+    {
+        page->listed = true;
+        get_size_classes()[page->size_class].available.push_back(page);
+    }
+}
+
+/**
+ * pages of small objects which become empty
+ *  are kept until the next major sweep
+*/
+void Heap::destroy(Object *obj)
+{
+    obj->~Object();
+    deallocate(obj);
+}
+
+namespace
+{
+// pages to sweep are taken away from pages by begin_sweep
+struct Sweeper
+{
+    uint32_t epoch;
+    Size next;
+    Size survivors;
+    std::vector<Size> types;
+    std::vector<Page *> pages;
+};
+
+Sweeper &get_sweeper()
+{
+    static Sweeper sweeper;
+    return sweeper;
+}
+}
+
+/**
+ * free lists of classes are rebuilt with pages which still have space
+ *  once they are swept, and pages allocated meanwhile are not swept
+*/
+void Heap::begin_sweep(uint32_t epoch) noexcept
+{
+    std::lock_guard<std::mutex> guard(get_lock());
+    auto classes = get_size_classes();
+    for (Size i = 0; i < kClassCount; ++i)
+    {
+        classes[i].current = nullptr;
+        classes[i].available.clear();
+    }
+
+    auto &sweeper = get_sweeper();
+    sweeper.epoch = epoch;
+    sweeper.next = 0;
+    sweeper.survivors = 0;
+    sweeper.types.clear();
+    sweeper.pages.swap(get_pages());
+    for (auto page : sweeper.pages)
+    {
+        page->listed = false;
+    }
+}
+
+/**
+ * the page is walked linearly by bits of used cells,
+ *  only the sweeping thread touches it until it's back in pages
+*/
+bool Heap::sweep_page(Size &cells)
+{
+    auto &sweeper = get_sweeper();
+    if (sweeper.next == sweeper.pages.size())
+    {
+        return false;
+    }
+
+    auto page = sweeper.pages[sweeper.next++];
+    for (Size word = 0; word * 64 < page->cells; ++word)
+    {
+        for (auto bits = page->used[word]; bits; bits &= bits - 1)
+        {
+            auto ind = word * 64 + __builtin_ctzll(bits);
+            auto obj = reinterpret_cast<Object *>(cell_of(page, ind));
+            if (obj->mark_ != sweeper.epoch)
+            {
+                obj->~Object();
+                put(page, ind);
+            }
+            else
+            {
+                auto type = Size(obj->type_id());
+                if (type >= sweeper.types.size())
+                {
+                    sweeper.types.resize(type + 1);
+                }
+                sweeper.types[type] += page->cell_size;
+            }
+        }
+    }
+    cells += page->cells;
+    sweeper.survivors += page->live * page->cell_size;
+
+    if (page->live == 0)
+    {
+        release(page);
+        return true;
+    }
+
+    std::lock_guard<std::mutex> guard(get_lock());
+    get_pages().push_back(page);
+    page->listed = page->size_class != kLargeClass && !is_full(page);
+    if (page->listed)
+    {
+        get_size_classes()[page->size_class].available.push_back(page);
+    }
+    return true;
+}
+
+Size Heap::end_sweep(std::vector<Size> &types) noexcept
+{
+    auto &sweeper = get_sweeper();
+    sweeper.pages.clear();
+    types.swap(sweeper.types);
+    return sweeper.survivors;
+}
+
+namespace
+{
+std::vector<Page *> &get_evacuated()
+{
+    static std::vector<Page *> evacuated;
+    return evacuated;
+}
+}
+
+/**
+ * evacuated pages are regarded as listed,
+ *  so that they won't be available when objects are moved out
+*/
+std::vector<Object *> Heap::begin_evacuate(double ratio)
+{
+    std::lock_guard<std::mutex> guard(get_lock());
+    std::vector<Page *> sparse[kClassCount];
+    for (auto page : get_pages())
+    {
+        if (page->size_class != kLargeClass && page->live < page->cells * ratio)
+        {
+            sparse[page->size_class].push_back(page);
+        }
+    }
+
+    std::vector<Object *> objects;
+    auto classes = get_size_classes();
+    auto &evacuated = get_evacuated();
+    for (Size i = 0; i < kClassCount; ++i)
+    {
+        if (sparse[i].size() < 2)
+        {
+            continue;
+        }
+
+        for (auto page : sparse[i])
+        {
+            page->evacuated = true;
+            page->listed = true;
+            evacuated.push_back(page);
+            for (Size word = 0; word * 64 < page->cells; ++word)
+            {
+                for (auto bits = page->used[word]; bits; bits &= bits - 1)
+                {
+                    objects.push_back(reinterpret_cast<Object *>(
+                        cell_of(page, word * 64 + __builtin_ctzll(bits))
+                    ));
+                }
+            }
+        }
+
+        auto &klass = classes[i];
+        if (klass.current && klass.current->evacuated)
+        {
+            klass.current = nullptr;
+        }
+        klass.available.erase(
+            std::remove_if(klass.available.begin(), klass.available.end(),
+                [](Page *page) { return page->evacuated; }
+            ),
+            klass.available.end()
+        );
+    }
+    return objects;
+}
+
+// pages still holding objects which can't be moved are kept
+void Heap::end_evacuate() noexcept
+{
+    std::lock_guard<std::mutex> guard(get_lock());
+    auto &pages = get_pages();
+    pages.erase(
+        std::remove_if(pages.begin(), pages.end(),
+            [](Page *page) { return page->evacuated && page->live == 0; }
+        ),
+        pages.end()
+    );
+
+    for (auto page : get_evacuated())
+    {
+        if (page->live == 0)
+        {
+            release(page);
+            continue;
+        }
+        page->evacuated = false;
+        page->listed = !is_full(page);
+        if (page->listed)
+        {
+            get_size_classes()[page->size_class].available.push_back(page);
+        }
+    }
+    get_evacuated().clear();
+}
+
+Size Heap::size_of(const Object *obj) noexcept
+{
+    return page_of(obj)->cell_size;
+}
+
+Size Heap::page_count() noexcept
+{
+    std::lock_guard<std::mutex> guard(get_lock());
+    return get_pages().size();
+}
+
+Size Heap::mapped_bytes() noexcept
+{
+    return get_mapped_bytes().load(std::memory_order_relaxed);
+}
+}
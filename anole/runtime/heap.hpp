@@ -0,0 +1,71 @@
+#ifndef __ANOLE_RUNTIME_HEAP_HPP__
+#define __ANOLE_RUNTIME_HEAP_HPP__
+
+#include "../base.hpp"
+
+#include <vector>
+#include <cstdint>
+
+namespace anole
+{
+class Object;
+
+/**
+ * the heap keeps objects allocated by Allocator<Object> in pages,
+ *  each page is aligned to its size and only holds cells of one size class,
+ *  so the page of an object is found by its address
+ *
+ * cells are bumped from new pages and popped from free lists of pages,
+ *  objects larger than all size classes have pages of their own
+ *
+ * pages are mapped from the OS directly
+ *  and returned to it once they become empty by sweeping
+*/
+class Heap
+{
+  public:
+    static constexpr Size kPageSize = Size(1) << 16;
+    static constexpr Size kMaxCellSize = 256;
+
+    static void *allocate(Size size);
+    // only for objects whose construction failed
+    static void deallocate(void *ptr);
+
+    /**
+     * pages are swept one by one between begin_sweep and end_sweep,
+     *  objects not marked with the epoch are destroyed
+     *  and pages which become empty are returned,
+     *  bytes of survivors are returned by end_sweep
+     *  and given by their types, indexed by ObjectType
+     *
+     * sweep_page may be called by another thread
+     *  while objects are allocated and deallocated
+    */
+    static void begin_sweep(uint32_t epoch) noexcept;
+    // return false if no page is left, cells walked are added to the count
+    static bool sweep_page(Size &cells);
+    static Size end_sweep(std::vector<Size> &types) noexcept;
+
+    // destroy the object by minor collections
+    static void destroy(Object *obj);
+
+    /**
+     * pages of small objects less full than the ratio are evacuated
+     *  if there are two of them in a size class at least,
+     *  objects in them are returned to be moved by compaction,
+     *  and cells of them are not allocated until end_evacuate,
+     *  where pages which have become empty are returned
+    */
+    static std::vector<Object *> begin_evacuate(double ratio);
+    static void end_evacuate() noexcept;
+
+    // bytes of the cell holding the object
+    static Size size_of(const Object *obj) noexcept;
+
+    static Size page_count() noexcept;
+    // bytes of pages mapped from the OS
+    static Size mapped_bytes() noexcept;
+};
+}
+
+#endif
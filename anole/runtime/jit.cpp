@@ -0,0 +1,994 @@
+#include "jit.hpp"
+#include "runtime.hpp"
+
+#include "../objects/objects.hpp"
+#include "../compiler/compiler.hpp"
+
+#include <map>
+#include <vector>
+#include <cstring>
+#include <exception>
+
+#if defined(__x86_64__) && defined(__linux__)
+    #define ANOLE_JIT_SUPPORTED
+    #include <unistd.h>
+    #include <sys/mman.h>
+#endif
+
+namespace anole
+{
+namespace
+{
+Size localThreshold = Jit::kDefaultThreshold;
+
+// the exception thrown by the helper, thrown again once native code exits
+std::exception_ptr localPending;
+
+using Helper = int (*)(Context *, Size, Oprand);
+
+/**
+ * native code goes on with the entry of the context switched to
+ *  by calls and returns, which is returned in rax and rdx,
+ *  or exits if it has no entry
+*/
+struct Switch
+{
+    const void *entry;
+    Context *ctx;
+};
+
+/**
+ * helpers set pc of the context before running the instruction,
+ *  so that errors are located as the interpreter does,
+ *  and exceptions are kept instead of unwinding native code
+*/
+template<int (*Body)(Context *, Size, Oprand)>
+int guarded(Context *ctx, Size pc, Oprand oprand) noexcept
+{
+    ctx->pc() = pc;
+    try
+    {
+        return Body(ctx, pc, oprand);
+    }
+    catch (...)
+    {
+        localPending = std::current_exception();
+        return Jit::kExit;
+    }
+}
+
+template<void (*Handle)()>
+Switch switched(Context *ctx, Size pc, Oprand) noexcept
+{
+    ctx->pc() = pc;
+    try
+    {
+        Handle();
+        auto next = theCurrContext.get();
+        return { next->code()->native_entry(next->pc()), next };
+    }
+    catch (...)
+    {
+        localPending = std::current_exception();
+        return { nullptr, nullptr };
+    }
+}
+
+// handlers of the interpreter which don't switch the context
+template<void (*Handle)(), int kStatus = Jit::kNext>
+int handled(Context *, Size, Oprand)
+{
+    Handle();
+    return kStatus;
+}
+
+/**
+ * thunks not computed yet are left to the interpreter,
+ *  and plain values of variables only read as values are pushed
+ *  without their variables, see read_as_value
+*/
+template<bool kValue>
+int push_loaded(Context *ctx, const Address &addr)
+{
+    auto value = addr->value();
+    if constexpr (kValue)
+    {
+        if (is_plain(value))
+        {
+            ctx->push(value);
+            return Jit::kNext;
+        }
+    }
+    auto obj = value.heap_object();
+    if (obj == nullptr || !obj->is<ObjectType::Thunk>())
+    {
+        ctx->push(addr);
+        return Jit::kNext;
+    }
+    auto thunk = reinterpret_cast<ThunkObject *>(obj);
+    if (thunk->computed())
+    {
+        ctx->push(thunk->result());
+        return Jit::kNext;
+    }
+    return Jit::kExit;
+}
+
+int exit_at(Context *ctx, Size pc, Oprand)
+{
+    ctx->pc() = pc;
+    return Jit::kExit;
+}
+
+int safepoint(Context *, Size, Oprand)
+{
+    Collector::try_gc();
+    return Jit::kNext;
+}
+
+int pop(Context *ctx, Size, Oprand oprand)
+{
+    ctx->pop(oprand);
+    return Jit::kNext;
+}
+
+int load_const(Context *ctx, Size, Oprand oprand)
+{
+    ctx->push(ctx->code()->load_const(oprand));
+    return Jit::kNext;
+}
+
+template<bool kValue>
+int load_local(Context *ctx, Size, Oprand oprand)
+{
+    if (auto addr = ctx->scope()->find_slot(variable_slot(oprand)))
+    {
+        return push_loaded<kValue>(ctx, *addr);
+    }
+    return Jit::kExit;
+}
+
+template<bool kValue>
+int load_upvalue(Context *ctx, Size, Oprand oprand)
+{
+    if (auto addr = find_variable(ctx, oprand))
+    {
+        return push_loaded<kValue>(ctx, *addr);
+    }
+    return Jit::kExit;
+}
+
+// loads by names not quickened yet, like ones in modules compiled by Aot
+template<bool kValue>
+int load(Context *ctx, Size pc, Oprand oprand)
+{
+    if (variable_has_slot(oprand))
+    {
+        return load_upvalue<kValue>(ctx, pc, oprand);
+    }
+    return push_loaded<kValue>(ctx,
+        ctx->scope()->load_symbol(ctx->code()->atom_at(oprand))
+    );
+}
+
+int load_builtin(Context *ctx, Size, Oprand oprand)
+{
+    auto name = ctx->code()->atom_at(oprand);
+    if (Scope::definitions(name))
+    {
+        return Jit::kExit;
+    }
+    ctx->push(BuiltInFunctionObject::load_built_in_function(name));
+    return Jit::kNext;
+}
+
+template<bool kValue>
+int load_global(Context *ctx, Size pc, Oprand oprand)
+{
+    if (Scope::definitions(ctx->code()->atom_at(oprand)) != 1)
+    {
+        return Jit::kExit;
+    }
+    return push_loaded<kValue>(ctx, ctx->code()->global_cell(pc));
+}
+
+int store(Context *ctx, Size, Oprand)
+{
+    auto addr = ctx->pop_address();
+    addr->bind(ctx->pop_value());
+    ctx->push(std::move(addr));
+    return Jit::kNext;
+}
+
+int store_slot(Context *ctx, Size, Oprand oprand)
+{
+    auto slot = variable_slot(oprand);
+    if (auto addr = ctx->scope()->find_slot(slot))
+    {
+        (*addr)->bind(ctx->pop_value());
+    }
+    else
+    {
+        auto created = ctx->scope()->create_symbol(ctx->code()->atom_at(variable_name(oprand)));
+        created->bind(ctx->pop_value());
+        ctx->scope()->set_slot(slot, std::move(created));
+    }
+    return Jit::kNext;
+}
+
+int new_scope(Context *ctx, Size, Oprand)
+{
+    ctx->scope() = make_pooled<Scope>(ctx->scope());
+    return Jit::kNext;
+}
+
+int end_scope(Context *ctx, Size, Oprand)
+{
+    ctx->scope() = ctx->scope()->pre();
+    return Jit::kNext;
+}
+
+int call_ac(Context *ctx, Size, Oprand)
+{
+    ctx->set_call_anchor();
+    return Jit::kNext;
+}
+
+int jump_if(Context *ctx, Size pc, Oprand oprand)
+{
+    if (ctx->pop_value().to_bool())
+    {
+        if (oprand < pc)
+        {
+            Collector::try_gc();
+        }
+        return Jit::kJump;
+    }
+    return Jit::kNext;
+}
+
+int jump_if_not(Context *ctx, Size, Oprand)
+{
+    return ctx->pop_value().to_bool() ? Jit::kNext : Jit::kJump;
+}
+
+int match(Context *ctx, Size, Oprand)
+{
+    auto key = ctx->pop_value();
+    if (ctx->top_value().ceq(key).to_bool())
+    {
+        ctx->pop();
+        return Jit::kJump;
+    }
+    return Jit::kNext;
+}
+
+int neg(Context *ctx, Size, Oprand)
+{
+    ctx->set_top(ctx->top_value().neg());
+    return Jit::kNext;
+}
+
+int bneg(Context *ctx, Size, Oprand)
+{
+    ctx->set_top(ctx->top_value().bneg());
+    return Jit::kNext;
+}
+
+// quickened instructions are compiled as generic ones
+template<Value (Value::*Op)(Value) const>
+int binary(Context *ctx, Size, Oprand)
+{
+    auto rhs = ctx->pop_value();
+    auto lhs = ctx->top_value();
+    ctx->set_top((lhs.*Op)(rhs));
+    return Jit::kNext;
+}
+
+int is(Context *ctx, Size, Oprand)
+{
+    auto rhs = ctx->pop_value();
+    ctx->set_top(Value::boolean(ctx->top_value().is(rhs)));
+    return Jit::kNext;
+}
+
+template<Value (Value::*Op)(Value) const>
+int compare_jump_if_not(Context *ctx, Size pc, Oprand)
+{
+    auto rhs = ctx->pop_value();
+    auto lhs = ctx->pop_value();
+    auto res = (lhs.*Op)(rhs);
+    ctx->pc() = pc + 1;
+    return res.to_bool() ? Jit::kNext : Jit::kJump;
+}
+
+/**
+ * superinstructions jump over the instructions they replace,
+ *  and they are left to the interpreter if variables are not plain
+*/
+int load_load_add(Context *ctx, Size pc, Oprand oprand)
+{
+    auto lhs_addr = find_variable(ctx, oprand);
+    auto rhs_addr = find_variable(ctx, ctx->code()->oprand_at(pc + 1));
+    if (!lhs_addr || !rhs_addr)
+    {
+        return Jit::kExit;
+    }
+    auto lhs = (*lhs_addr)->value(), rhs = (*rhs_addr)->value();
+    if (!is_plain(lhs) || !is_plain(rhs))
+    {
+        return Jit::kExit;
+    }
+    ctx->pc() = pc + 2;
+    ctx->push(lhs.add(rhs));
+    return Jit::kJump;
+}
+
+template<Value (Value::*Op)(Value) const>
+int load_const_op(Context *ctx, Size pc, Oprand oprand)
+{
+    auto addr = find_variable(ctx, oprand);
+    if (!addr || !is_plain((*addr)->value()))
+    {
+        return Jit::kExit;
+    }
+    ctx->pc() = pc + 2;
+    ctx->push(((*addr)->value().*Op)(ctx->code()->load_const(ctx->code()->oprand_at(pc + 1))));
+    return Jit::kJump;
+}
+
+int load_store_pop(Context *ctx, Size pc, Oprand oprand)
+{
+    auto addr = find_variable(ctx, oprand);
+    if (!addr)
+    {
+        return Jit::kExit;
+    }
+    auto obj = (*addr)->value().heap_object();
+    if (obj != nullptr && obj->is<ObjectType::Thunk>())
+    {
+        return Jit::kExit;
+    }
+    ctx->pc() = pc + 1;
+    (*addr)->bind(ctx->pop_value());
+    return Jit::kJump;
+}
+
+int store_pop(Context *ctx, Size, Oprand)
+{
+    auto addr = ctx->pop_address();
+    addr->bind(ctx->pop_value());
+    return Jit::kJump;
+}
+
+using Template = Jit::Template;
+
+/**
+ * whether the slot pushed by the load at pc is only read as a value
+ *  by the instruction popping it, like oprands of arithmetic,
+ *  conditions, callees and values stored, then its variable is not needed
+*/
+bool read_as_value(const Code &code, Size pc)
+{
+    // slots pushed above the one loaded
+    Size depth = 0;
+    for (auto i = pc + 1; i < code.size(); ++i)
+    {
+        switch (code.opcode_at(i))
+        {
+        case Opcode::Load:
+        case Opcode::LoadConst:
+        case Opcode::LoadLocal:
+        case Opcode::LoadUpvalue:
+        case Opcode::LoadBuiltin:
+        case Opcode::LoadGlobal:
+            ++depth;
+            break;
+
+        case Opcode::Neg:
+        case Opcode::BNeg:
+            if (depth == 0)
+            {
+                return true;
+            }
+            break;
+
+        case Opcode::Add: case Opcode::Sub: case Opcode::Mul:
+        case Opcode::Div: case Opcode::Mod: case Opcode::Is:
+        case Opcode::CEQ: case Opcode::CNE: case Opcode::CLT: case Opcode::CLE:
+        case Opcode::BOr: case Opcode::BXor: case Opcode::BAnd:
+        case Opcode::BLS: case Opcode::BRS:
+        case Opcode::AddIntInt: case Opcode::SubIntInt: case Opcode::MulIntInt:
+        case Opcode::CEQIntInt: case Opcode::CNEIntInt:
+        case Opcode::CLTIntInt: case Opcode::CLEIntInt:
+        case Opcode::AddFloatFloat: case Opcode::SubFloatFloat:
+        case Opcode::MulFloatFloat: case Opcode::DivFloatFloat:
+        case Opcode::CLTFloatFloat: case Opcode::CLEFloatFloat:
+            if (depth <= 1)
+            {
+                return true;
+            }
+            --depth;
+            break;
+
+        case Opcode::CEQJumpIfNot: case Opcode::CNEJumpIfNot:
+        case Opcode::CLTJumpIfNot: case Opcode::CLEJumpIfNot:
+        case Opcode::CEQIntIntJumpIfNot: case Opcode::CNEIntIntJumpIfNot:
+        case Opcode::CLTIntIntJumpIfNot: case Opcode::CLEIntIntJumpIfNot:
+            return depth <= 1;
+
+        case Opcode::JumpIf:
+        case Opcode::JumpIfNot:
+        case Opcode::StoreLocal:
+        case Opcode::StoreSlot:
+        case Opcode::Call:
+        case Opcode::FastCall:
+        case Opcode::TailCall:
+        case Opcode::FastTailCall:
+            return depth == 0;
+
+        default:
+            return false;
+        }
+    }
+    return false;
+}
+
+Template translate(const Code &code, Size pc)
+{
+    using Kind = Template::Kind;
+
+    if (pc >= code.size())
+    {
+        return { Kind::Exit, reinterpret_cast<const void *>(&exit_at), 0, 0 };
+    }
+
+    auto &ins = code.ins_at(pc);
+    auto plain = [pc](Helper helper)
+    {
+        return Template{ Kind::Plain, reinterpret_cast<const void *>(helper), 0, pc + 1 };
+    };
+    auto branch = [](Helper helper, Size target, Size next)
+    {
+        return Template{ Kind::Branch, reinterpret_cast<const void *>(helper), target, next };
+    };
+    auto switching = [](Switch (*helper)(Context *, Size, Oprand))
+    {
+        return Template{ Kind::Switch, reinterpret_cast<const void *>(helper), 0, 0 };
+    };
+
+    switch (ins.opcode)
+    {
+    case Opcode::PlaceHolder:
+        return { Kind::Skip, nullptr, 0, pc + 1 };
+    case Opcode::Jump:
+        return { Kind::Jump, reinterpret_cast<const void *>(&guarded<safepoint>), ins.oprand, 0 };
+
+    case Opcode::Call:          return switching(&switched<op_handles::call_handle>);
+    case Opcode::FastCall:      return switching(&switched<op_handles::fastcall_handle>);
+    case Opcode::TailCall:      return switching(&switched<op_handles::tailcall_handle>);
+    case Opcode::FastTailCall:  return switching(&switched<op_handles::fasttailcall_handle>);
+    case Opcode::Return:        return switching(&switched<op_handles::return_handle>);
+    case Opcode::ReturnNone:    return switching(&switched<op_handles::returnnone_handle>);
+
+    case Opcode::Pop:           return plain(&guarded<pop>);
+    case Opcode::LoadConst:     return plain(&guarded<load_const>);
+    case Opcode::Load:
+        return read_as_value(code, pc)
+            ? plain(&guarded<load<true>>) : plain(&guarded<load<false>>);
+    case Opcode::LoadLocal:
+        return read_as_value(code, pc)
+            ? plain(&guarded<load_local<true>>) : plain(&guarded<load_local<false>>);
+    case Opcode::LoadUpvalue:
+        return read_as_value(code, pc)
+            ? plain(&guarded<load_upvalue<true>>) : plain(&guarded<load_upvalue<false>>);
+    case Opcode::LoadBuiltin:   return plain(&guarded<load_builtin>);
+    case Opcode::LoadGlobal:
+        return read_as_value(code, pc)
+            ? plain(&guarded<load_global<true>>) : plain(&guarded<load_global<false>>);
+    case Opcode::Store:         return plain(&guarded<store>);
+    case Opcode::StoreRef:      return plain(&guarded<handled<op_handles::storeref_handle>>);
+    case Opcode::StoreLocal:    return plain(&guarded<handled<op_handles::storelocal_handle>>);
+    case Opcode::StoreSlot:     return plain(&guarded<store_slot>);
+    case Opcode::StoreRefSlot:  return plain(&guarded<handled<op_handles::storerefslot_handle>>);
+    case Opcode::NewScope:      return plain(&guarded<new_scope>);
+    case Opcode::EndScope:      return plain(&guarded<end_scope>);
+    case Opcode::CallAc:        return plain(&guarded<call_ac>);
+    case Opcode::Pack:          return plain(&guarded<handled<op_handles::pack_handle>>);
+    case Opcode::Neg:           return plain(&guarded<neg>);
+    case Opcode::BNeg:          return plain(&guarded<bneg>);
+    case Opcode::Is:            return plain(&guarded<is>);
+    case Opcode::Index:         return plain(&guarded<handled<op_handles::index_handle>>);
+    case Opcode::BuildList:     return plain(&guarded<handled<op_handles::buildlist_handle>>);
+    case Opcode::BuildDict:     return plain(&guarded<handled<op_handles::builddict_handle>>);
+
+    case Opcode::Add:
+    case Opcode::AddIntInt:
+    case Opcode::AddFloatFloat:
+        return plain(&guarded<binary<&Value::add>>);
+    case Opcode::Sub:
+    case Opcode::SubIntInt:
+    case Opcode::SubFloatFloat:
+        return plain(&guarded<binary<&Value::sub>>);
+    case Opcode::Mul:
+    case Opcode::MulIntInt:
+    case Opcode::MulFloatFloat:
+        return plain(&guarded<binary<&Value::mul>>);
+    case Opcode::Div:
+    case Opcode::DivFloatFloat:
+        return plain(&guarded<binary<&Value::div>>);
+    case Opcode::Mod:   return plain(&guarded<binary<&Value::mod>>);
+    case Opcode::BOr:   return plain(&guarded<binary<&Value::bor>>);
+    case Opcode::BXor:  return plain(&guarded<binary<&Value::bxor>>);
+    case Opcode::BAnd:  return plain(&guarded<binary<&Value::band>>);
+    case Opcode::BLS:   return plain(&guarded<binary<&Value::bls>>);
+    case Opcode::BRS:   return plain(&guarded<binary<&Value::brs>>);
+    case Opcode::CEQ:
+    case Opcode::CEQIntInt:
+        return plain(&guarded<binary<&Value::ceq>>);
+    case Opcode::CNE:
+    case Opcode::CNEIntInt:
+        return plain(&guarded<binary<&Value::cne>>);
+    case Opcode::CLT:
+    case Opcode::CLTIntInt:
+    case Opcode::CLTFloatFloat:
+        return plain(&guarded<binary<&Value::clt>>);
+    case Opcode::CLE:
+    case Opcode::CLEIntInt:
+    case Opcode::CLEFloatFloat:
+        return plain(&guarded<binary<&Value::cle>>);
+
+    case Opcode::JumpIf:
+        return branch(&guarded<jump_if>, ins.oprand, pc + 1);
+    case Opcode::JumpIfNot:
+        return branch(&guarded<jump_if_not>, ins.oprand, pc + 1);
+    case Opcode::Match:
+        return branch(&guarded<match>, ins.oprand, pc + 1);
+    case Opcode::LambdaDecl:
+        return branch(&guarded<handled<op_handles::lambdadecl_handle, Jit::kJump>>,
+            unpack_oprand(ins.oprand).second, pc + 1);
+    case Opcode::ThunkDecl:
+        return branch(&guarded<handled<op_handles::thunkdecl_handle, Jit::kJump>>,
+            ins.oprand, pc + 1);
+
+    case Opcode::CEQJumpIfNot:
+    case Opcode::CEQIntIntJumpIfNot:
+        return branch(&guarded<compare_jump_if_not<&Value::ceq>>,
+            code.oprand_at(pc + 1), pc + 2);
+    case Opcode::CNEJumpIfNot:
+    case Opcode::CNEIntIntJumpIfNot:
+        return branch(&guarded<compare_jump_if_not<&Value::cne>>,
+            code.oprand_at(pc + 1), pc + 2);
+    case Opcode::CLTJumpIfNot:
+    case Opcode::CLTIntIntJumpIfNot:
+        return branch(&guarded<compare_jump_if_not<&Value::clt>>,
+            code.oprand_at(pc + 1), pc + 2);
+    case Opcode::CLEJumpIfNot:
+    case Opcode::CLEIntIntJumpIfNot:
+        return branch(&guarded<compare_jump_if_not<&Value::cle>>,
+            code.oprand_at(pc + 1), pc + 2);
+
+    case Opcode::LoadLoadAdd:
+        return branch(&guarded<load_load_add>, pc + 3, pc + 1);
+    case Opcode::LoadConstAdd:
+        return branch(&guarded<load_const_op<&Value::add>>, pc + 3, pc + 1);
+    case Opcode::LoadConstSub:
+        return branch(&guarded<load_const_op<&Value::sub>>, pc + 3, pc + 1);
+    case Opcode::LoadStorePop:
+        return branch(&guarded<load_store_pop>, pc + 3, pc + 1);
+    case Opcode::StorePop:
+        return branch(&guarded<store_pop>, pc + 2, pc + 1);
+
+    /**
+     * others which may switch the context like thunks,
+     *  and ones rarely in hot code like imports and classes
+    */
+    default:
+        return { Kind::Exit, reinterpret_cast<const void *>(&exit_at), 0, 0 };
+    }
+}
+
+#ifdef ANOLE_JIT_SUPPORTED
+/**
+ * native code of instructions in [begin, end) is emitted into one chunk,
+ *  rbx keeps the context for helpers and the exit pops it and returns,
+ *  the trampoline pushes it and jumps to the entry:
+ *
+ *    trampoline:   push rbx; mov rbx, rdi; jmp rsi
+ *    exit:         pop rbx; ret
+ *    each one:     mov rdi, rbx; mov rsi, pc; mov rdx, oprand;
+ *                  mov rax, helper; call rax; ...checks of the status
+ *
+ * jumps out of the range exit with the target as pc by stubs
+*/
+class Assembler
+{
+  public:
+    Assembler(const Code &code, Size begin, Size end, const uint8_t *base)
+      : code_(code), begin_(begin), end_(end), base_(base)
+      , labels_(end - begin)
+    {
+        // ...
+    }
+
+    void assemble()
+    {
+        emit({ 0x5b, 0xc3 });
+
+        for (auto pc = begin_; pc < end_; ++pc)
+        {
+            labels_[pc - begin_] = bytes_.size();
+            assemble(pc, translate(code_, pc));
+        }
+        jump_to(end_);
+
+        for (auto &[target, fixups] : stubs_)
+        {
+            auto stub = bytes_.size();
+            call(reinterpret_cast<const void *>(&exit_at), target, 0);
+            jump_exit(0);
+            for (auto fixup : fixups)
+            {
+                patch(fixup, stub);
+            }
+        }
+        for (auto &[fixup, pc] : fixups_)
+        {
+            patch(fixup, labels_[pc - begin_]);
+        }
+    }
+
+    const std::vector<uint8_t> &bytes() const noexcept
+    {
+        return bytes_;
+    }
+
+    Size label(Size pc) const noexcept
+    {
+        return labels_[pc - begin_];
+    }
+
+  private:
+    void assemble(Size pc, const Template &tpl)
+    {
+        using Kind = Template::Kind;
+
+        switch (tpl.kind)
+        {
+        case Kind::Skip:
+            break;
+
+        case Kind::Exit:
+            call(reinterpret_cast<const void *>(&exit_at), pc, 0);
+            jump_exit(0);
+            break;
+
+        case Kind::Jump:
+            if (tpl.target < pc)
+            {
+                call(tpl.helper, pc, 0);
+                test_exit();
+            }
+            jump_to(tpl.target);
+            break;
+
+        case Kind::Plain:
+            call(tpl.helper, pc, code_.oprand_at(pc));
+            test_exit();
+            break;
+
+        case Kind::Branch:
+            call(tpl.helper, pc, code_.oprand_at(pc));
+            // cmp eax, 1; je target; ja exit
+            emit({ 0x83, 0xf8, 0x01 });
+            jump_to(tpl.target, 0x84);
+            jump_exit(0x87);
+            if (tpl.next != pc + 1)
+            {
+                jump_to(tpl.next);
+            }
+            break;
+
+        case Kind::Switch:
+            call(tpl.helper, pc, code_.oprand_at(pc));
+            // test rax, rax; je exit; mov rbx, rdx; jmp rax
+            emit({ 0x48, 0x85, 0xc0 });
+            jump_exit(0x84);
+            emit({ 0x48, 0x89, 0xd3, 0xff, 0xe0 });
+            break;
+        }
+    }
+
+    void emit(std::initializer_list<uint8_t> bytes)
+    {
+        bytes_.insert(bytes_.end(), bytes);
+    }
+
+    void emit64(uint64_t value)
+    {
+        for (int i = 0; i < 8; ++i)
+        {
+            bytes_.push_back(uint8_t(value >> (i * 8)));
+        }
+    }
+
+    void call(const void *helper, Size pc, Oprand oprand)
+    {
+        // mov rdi, rbx
+        emit({ 0x48, 0x89, 0xdf });
+        // mov rsi, pc; mov rdx, oprand
+        move(0xbe, pc);
+        move(0xba, oprand);
+        // call rel32 if the helper is near, or mov rax, helper; call rax
+        auto rel = reinterpret_cast<int64_t>(helper)
+            - reinterpret_cast<int64_t>(base_ + bytes_.size() + 5);
+        if (base_ && INT32_MIN <= rel && rel <= INT32_MAX)
+        {
+            emit({ 0xe8 });
+            auto rel32 = int32_t(rel);
+            bytes_.insert(bytes_.end(), reinterpret_cast<uint8_t *>(&rel32),
+                reinterpret_cast<uint8_t *>(&rel32) + 4);
+        }
+        else
+        {
+            emit({ 0x48, 0xb8 });
+            emit64(reinterpret_cast<uint64_t>(helper));
+            emit({ 0xff, 0xd0 });
+        }
+    }
+
+    // mov by the opcode of the register, in 32 bits if it fits
+    void move(uint8_t op, uint64_t value)
+    {
+        if (value <= UINT32_MAX)
+        {
+            emit({ op });
+            for (int i = 0; i < 4; ++i)
+            {
+                bytes_.push_back(uint8_t(value >> (i * 8)));
+            }
+        }
+        else
+        {
+            emit({ 0x48, op });
+            emit64(value);
+        }
+    }
+
+    // test eax, eax; jne exit
+    void test_exit()
+    {
+        emit({ 0x85, 0xc0 });
+        jump_exit(0x85);
+    }
+
+    // jmp, or jcc by the second byte of its opcode, to the exit
+    void jump_exit(uint8_t cc)
+    {
+        patch(jump(cc), 0);
+    }
+
+    // instructions out of the range are jumped to by stubs
+    void jump_to(Size target, uint8_t cc = 0)
+    {
+        auto fixup = jump(cc);
+        if (begin_ <= target && target < end_)
+        {
+            fixups_.emplace_back(fixup, target);
+        }
+        else
+        {
+            stubs_[target].push_back(fixup);
+        }
+    }
+
+    // the offset of rel32 is returned to be patched
+    Size jump(uint8_t cc)
+    {
+        if (cc)
+        {
+            emit({ 0x0f, cc });
+        }
+        else
+        {
+            emit({ 0xe9 });
+        }
+        emit({ 0, 0, 0, 0 });
+        return bytes_.size() - 4;
+    }
+
+    void patch(Size fixup, Size offset)
+    {
+        auto rel = int32_t(int64_t(offset) - int64_t(fixup + 4));
+        std::memcpy(bytes_.data() + fixup, &rel, 4);
+    }
+
+  private:
+    const Code &code_;
+    Size begin_, end_;
+    const uint8_t *base_;
+    std::vector<Size> labels_;
+    std::vector<uint8_t> bytes_;
+    std::vector<std::pair<Size, Size>> fixups_;
+    std::map<Size, std::vector<Size>> stubs_;
+};
+
+Size page_size()
+{
+    static const Size page = sysconf(_SC_PAGESIZE);
+    return page;
+}
+
+/**
+ * pages are mapped near helpers if possible,
+ *  so that they can be called by relative calls
+*/
+uint8_t *map_pages(Size size)
+{
+    static auto near = (reinterpret_cast<uintptr_t>(&exit_at) - (uintptr_t(1) << 30))
+        & ~uintptr_t(page_size() - 1);
+
+    size = (size + page_size() - 1) / page_size() * page_size();
+    auto ptr = mmap(reinterpret_cast<void *>(near), size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0
+    );
+    if (ptr == MAP_FAILED)
+    {
+        return nullptr;
+    }
+    near = reinterpret_cast<uintptr_t>(ptr) + size;
+    return static_cast<uint8_t *>(ptr);
+}
+
+// pages of native code are readable and executable once they are written
+bool seal(uint8_t *pages, Size size, const std::vector<uint8_t> &bytes)
+{
+    size = (size + page_size() - 1) / page_size() * page_size();
+    std::memcpy(pages, bytes.data(), bytes.size());
+    if (mprotect(pages, size, PROT_READ | PROT_EXEC))
+    {
+        munmap(pages, size);
+        return false;
+    }
+    return true;
+}
+
+using Trampoline = void (*)(Context *, const void *);
+
+Trampoline trampoline()
+{
+    static auto trampoline = []() -> Trampoline
+    {
+        std::vector<uint8_t> bytes{ 0x53, 0x48, 0x89, 0xfb, 0xff, 0xe6 };
+        auto pages = map_pages(bytes.size());
+        if (pages == nullptr || !seal(pages, bytes.size(), bytes))
+        {
+            return nullptr;
+        }
+        return reinterpret_cast<Trampoline>(pages);
+    }();
+    return trampoline;
+}
+#endif
+}
+
+bool Jit::supported() noexcept
+{
+  #ifdef ANOLE_JIT_SUPPORTED
+    return true;
+  #else
+    return false;
+  #endif
+}
+
+void Jit::set_enabled(bool enabled) noexcept
+{
+    enabled_ = enabled && supported();
+}
+
+void Jit::set_threshold(Size threshold) noexcept
+{
+    localThreshold = threshold ? threshold : 1;
+}
+
+Jit::Template Jit::translate(const Code &code, Size pc)
+{
+    return anole::translate(code, pc);
+}
+
+void Jit::count_call(Code &code, Size base)
+{
+    if (base == 0 || base >= code.size()
+        || code.opcode_at(base - 1) != Opcode::LambdaDecl)
+    {
+        return;
+    }
+    count_loop(code, base, unpack_oprand(code.oprand_at(base - 1)).second);
+}
+
+void Jit::count_loop(Code &code, Size begin, Size end)
+{
+    // codes compiled by Aot are left to it
+    if (code.native_entry(begin) || code.aot_entry(begin))
+    {
+        return;
+    }
+    auto &hotness = code.native_hotness_;
+    if (begin >= hotness.size())
+    {
+        hotness.resize(code.size());
+    }
+    if (++hotness[begin] >= localThreshold)
+    {
+        // failures are tried again after another round of counting
+        hotness[begin] = 0;
+        compile(code, begin, std::min(end, code.size()));
+    }
+}
+
+bool Jit::compile(Code &code, Size begin, Size end)
+{
+  #ifdef ANOLE_JIT_SUPPORTED
+    if (begin >= end || trampoline() == nullptr)
+    {
+        return false;
+    }
+
+    // code by relative calls is never longer than the one without them
+    Assembler far{code, begin, end, nullptr};
+    far.assemble();
+    auto size = far.bytes().size();
+    auto native = map_pages(size);
+    if (native == nullptr)
+    {
+        return false;
+    }
+    Assembler assembler{code, begin, end, native};
+    assembler.assemble();
+    if (!seal(native, size, assembler.bytes()))
+    {
+        return false;
+    }
+
+    auto &entries = code.native_entries_;
+    if (entries.size() < code.size())
+    {
+        entries.resize(code.size());
+    }
+    for (auto pc = begin; pc < end; ++pc)
+    {
+        if (entries[pc] == nullptr)
+        {
+            entries[pc] = native + assembler.label(pc);
+        }
+    }
+    return true;
+  #else
+    static_cast<void>(code);
+    static_cast<void>(begin);
+    static_cast<void>(end);
+    return false;
+  #endif
+}
+
+void Jit::run(Context *ctx, const void *entry)
+{
+  #ifdef ANOLE_JIT_SUPPORTED
+    trampoline()(ctx, entry);
+    rethrow_pending();
+  #else
+    static_cast<void>(ctx);
+    static_cast<void>(entry);
+  #endif
+}
+
+void Jit::rethrow_pending()
+{
+    if (localPending)
+    {
+        auto pending = std::move(localPending);
+        localPending = nullptr;
+        std::rethrow_exception(pending);
+    }
+}
+}
@@ -0,0 +1,111 @@
+#ifndef __ANOLE_RUNTIME_JIT_HPP__
+#define __ANOLE_RUNTIME_JIT_HPP__
+
+#include "../base.hpp"
+#include "../compiler/instruction.hpp"
+
+namespace anole
+{
+class Code;
+class Context;
+
+/**
+ * Jit compiles hot functions and loops to native code on x86-64 Linux,
+ *  functions are counted by calls and loops by their backward jumps,
+ *  and they are compiled once the counters reach the threshold
+ *
+ * it's a baseline template compiler, each instruction is translated
+ *  to a call of its helper, which does what the instruction does
+ *  in Context::execute, and jumps are translated to native jumps,
+ *  so only the dispatch is saved
+ *
+ * calls and returns switch theCurrContext by the handlers
+ *  of the interpreter, native code goes on with the context switched to
+ *  if it's compiled too, or it exits to Context::execute with the pc
+ *  left in the context, as at instructions which are not compiled,
+ *  and the interpreter enters native code again after calls, returns
+ *  and backward jumps, so calls still take no native stack
+ *  and continuations, thunks and tail calls work as before
+ *
+ * native code is kept in pages mapped from the OS until exit,
+ *  and it can't be enabled on other platforms
+*/
+class Jit
+{
+  public:
+    static constexpr Size kDefaultThreshold = 1000;
+
+    /**
+     * helpers return whether native code goes on with the next instruction,
+     *  jumps to the target of the instruction, or exits to the interpreter
+     *  with the pc left in the context
+    */
+    enum Status : int
+    {
+        kNext = 0,
+        kJump = 1,
+        kExit = 2,
+    };
+
+    /**
+     * how the instruction is compiled, by the helper and what to do after it,
+     *  helpers of Switch return the context switched to and its entry,
+     *  others return Status, and instructions without their own helpers
+     *  exit to the interpreter by the helper setting the pc
+     *
+     * templates are shared with Aot, see aot.hpp
+    */
+    struct Template
+    {
+        enum class Kind : uint8_t
+        {
+            Exit,
+            Skip,
+            Jump,
+            Plain,
+            Branch,
+            Switch,
+        };
+
+        Kind kind;
+        const void *helper;
+        // the target of branches and where to go on after the instruction
+        Size target;
+        Size next;
+    };
+
+    // instructions out of the code are translated to exits too
+    static Template translate(const Code &code, Size pc);
+
+    static bool supported() noexcept;
+    static void set_enabled(bool enabled) noexcept;
+    static bool enabled() noexcept
+    {
+        return enabled_;
+    }
+
+    // calls or backward jumps before functions or loops are compiled
+    static void set_threshold(Size threshold) noexcept;
+
+    // count a call of the function whose body begins at base
+    static void count_call(Code &code, Size base);
+    // count a backward jump from the last instruction of the loop
+    static void count_loop(Code &code, Size begin, Size end);
+
+    /**
+     * run native code from the entry in the current context
+     *  until it exits, exceptions thrown by helpers are thrown again
+    */
+    static void run(Context *ctx, const void *entry);
+    // throw the exception kept by helpers again if any
+    static void rethrow_pending();
+
+  private:
+    static inline bool enabled_ = false;
+
+    // compile instructions in [begin, end) which have no entries yet
+    static bool compile(Code &code, Size begin, Size end);
+};
+}
+
+#endif
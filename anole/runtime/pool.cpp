@@ -0,0 +1,77 @@
+#include "pool.hpp"
+
+#include <new>
+#include <thread>
+
+namespace anole
+{
+namespace
+{
+// blocks are aligned to 16 bytes, one class for every 16 bytes
+constexpr Size kClassCount = Pool::kMaxBlockSize / 16;
+// blocks more than it in one class are not kept
+constexpr Size kMaxFreeBlocks = 4096;
+
+/**
+ * free blocks are linked by their first words,
+ *  the pool is trivially destructible
+ *  so that blocks can be released by statics destroyed at exit
+*/
+struct FreeLists
+{
+    std::thread::id owner;
+    void *heads[kClassCount];
+    Size counts[kClassCount];
+};
+
+FreeLists localFreeLists;
+
+Size block_class(Size size) noexcept
+{
+    return (size + 15) / 16 - 1;
+}
+
+// free lists belong to the thread allocating from them first
+bool owns() noexcept
+{
+    auto self = std::this_thread::get_id();
+    if (localFreeLists.owner == std::thread::id())
+    {
+        localFreeLists.owner = self;
+    }
+    return localFreeLists.owner == self;
+}
+}
+
+void *Pool::allocate(Size size)
+{
+    if (size && size <= kMaxBlockSize && owns())
+    {
+        auto ind = block_class(size);
+        if (auto block = localFreeLists.heads[ind])
+        {
+            localFreeLists.heads[ind] = *static_cast<void **>(block);
+            --localFreeLists.counts[ind];
+            return block;
+        }
+        return ::operator new((ind + 1) * 16);
+    }
+    return ::operator new(size);
+}
+
+void Pool::deallocate(void *ptr, Size size) noexcept
+{
+    if (size && size <= kMaxBlockSize && owns())
+    {
+        auto ind = block_class(size);
+        if (localFreeLists.counts[ind] < kMaxFreeBlocks)
+        {
+            *static_cast<void **>(ptr) = localFreeLists.heads[ind];
+            localFreeLists.heads[ind] = ptr;
+            ++localFreeLists.counts[ind];
+            return;
+        }
+    }
+    ::operator delete(ptr);
+}
+}
@@ -0,0 +1,73 @@
+#ifndef __ANOLE_RUNTIME_POOL_HPP__
+#define __ANOLE_RUNTIME_POOL_HPP__
+
+#include "../base.hpp"
+
+#include <memory>
+
+namespace anole
+{
+/**
+ * Pool recycles small blocks of contexts, scopes and variables,
+ *  which are created and released by each call,
+ *  blocks released are kept in free lists of size classes
+ *  and given back by later allocations of the same class
+ *
+ * free lists belong to the program's thread,
+ *  blocks released by other threads, like the sweeping helper,
+ *  and blocks larger than all classes go to operator delete
+*/
+class Pool
+{
+  public:
+    static constexpr Size kMaxBlockSize = 256;
+
+    static void *allocate(Size size);
+    static void deallocate(void *ptr, Size size) noexcept;
+};
+
+// the allocator for std containers and allocate_shared by Pool
+template<typename T>
+class PoolAllocator
+{
+  public:
+    using value_type = T;
+
+    PoolAllocator() noexcept = default;
+    template<typename U>
+    PoolAllocator(const PoolAllocator<U> &) noexcept {}
+
+    T *allocate(Size n)
+    {
+        return static_cast<T *>(Pool::allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T *ptr, Size n) noexcept
+    {
+        Pool::deallocate(ptr, n * sizeof(T));
+    }
+
+    template<typename U>
+    bool operator==(const PoolAllocator<U> &) const noexcept
+    {
+        return true;
+    }
+    template<typename U>
+    bool operator!=(const PoolAllocator<U> &) const noexcept
+    {
+        return false;
+    }
+};
+
+/**
+ * the object and its control block share one block of the pool,
+ *  which is recycled once the last reference is released
+*/
+template<typename T, typename ...Ts>
+SPtr<T> make_pooled(Ts &&...values)
+{
+    return std::allocate_shared<T>(PoolAllocator<T>(), std::forward<Ts>(values)...);
+}
+}
+
+#endif
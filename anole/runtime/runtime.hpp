@@ -1,8 +1,15 @@
 #ifndef __ANOLE_RUNTIME_HPP__
 #define __ANOLE_RUNTIME_HPP__
 
+#include "atom.hpp"
+#include "heap.hpp"
+#include "aot.hpp"
+#include "jit.hpp"
+#include "pool.hpp"
 #include "scope.hpp"
+#include "shape.hpp"
 #include "context.hpp"
+#include "handles.hpp"
 #include "variable.hpp"
 #include "allocator.hpp"
 #include "collector.hpp"
@@ -4,60 +4,143 @@
 
 namespace anole
 {
+namespace
+{
+// zero is for empty entries of member caches
+Size localLayouts = 0;
+
+// counts of definitions indexed by atoms
+std::vector<Size> localDefinitions;
+}
+
+Address &SymbolTable::insert(Atom atom)
+{
+    if (auto find = this->find(atom))
+    {
+        return *find;
+    }
+
+    // at most half of entries are used
+    if ((size_ + 1) * 2 > entries_.size())
+    {
+        grow();
+    }
+
+    auto mask = entries_.size() - 1;
+    auto i = hash(atom) & mask;
+    while (entries_[i].atom)
+    {
+        i = (i + 1) & mask;
+    }
+    ++size_;
+    entries_[i].atom = atom;
+    return entries_[i].addr;
+}
+
+void SymbolTable::grow()
+{
+    std::vector<Entry, PoolAllocator<Entry>> entries(entries_.empty() ? 8 : entries_.size() * 2);
+    std::swap(entries, entries_);
+
+    auto mask = entries_.size() - 1;
+    for (auto &entry : entries)
+    {
+        if (entry.atom)
+        {
+            auto i = hash(entry.atom) & mask;
+            while (entries_[i].atom)
+            {
+                i = (i + 1) & mask;
+            }
+            entries_[i] = std::move(entry);
+        }
+    }
+}
+
+Size Scope::new_layout() noexcept
+{
+    return ++localLayouts;
+}
+
+Size Scope::definitions(Atom name) noexcept
+{
+    return name < localDefinitions.size() ? localDefinitions[name] : 0;
+}
+
+void Scope::define(Atom name)
+{
+    if (name >= localDefinitions.size())
+    {
+        localDefinitions.resize(name + 1);
+    }
+    ++localDefinitions[name];
+}
+
 Scope::Scope() noexcept
-  : pre_scope_(nullptr)
+  : pre_scope_(nullptr), forks_(0), layout_(new_layout()), mark_(0)
 {
     // ...
 }
 
 Scope::Scope(SPtr<Scope> pre_scope) noexcept
-  : pre_scope_(std::move(pre_scope))
+  : pre_scope_(std::move(pre_scope)), forks_(0), layout_(new_layout()), mark_(0)
 {
     // ...
 }
 
+SPtr<Scope> Scope::fork(const SPtr<Scope> &scope)
+{
+    auto res = make_pooled<Scope>(scope);
+    res->slots_ = scope->slots_;
+    res->forks_ = scope->forks_ + 1;
+    return res;
+}
+
 SPtr<Scope> &Scope::pre()
 {
     return pre_scope_;
 }
 
-Address Scope::create_symbol(const String &name)
+Address Scope::create_symbol(Atom name)
 {
-    Address addr;
-
-    auto find = symbols_.find(name);
-    if (find == symbols_.end())
+    if (auto find = symbols_.find(name))
     {
-        addr = std::make_shared<Variable>();
-        symbols_[name] = addr;
+        return *find;
     }
-    else
-    {
-        addr = find->second;
-    }
-    addr->set_called_name(name);
 
+    auto &addr = symbols_.insert(name);
+    addr = make_pooled<Variable>();
+    layout_ = new_layout();
+    define(name);
     return addr;
 }
 
-void Scope::create_symbol(const String &name, Object *obj)
+void Scope::create_symbol(Atom name, Value value)
 {
-    symbols_[name] = std::make_shared<Variable>(obj);
+    symbols_.insert(name) = make_pooled<Variable>(value);
+    layout_ = new_layout();
+    define(name);
 }
 
-void Scope::create_symbol(const String &name, Address value)
+void Scope::create_symbol(Atom name, Address value)
 {
-    symbols_[name] = value;
+    if (value)
+    {
+        value->release();
+    }
+    Collector::shade(value);
+    symbols_.insert(name) = std::move(value);
+    layout_ = new_layout();
+    define(name);
 }
 
-Address Scope::load_symbol(const String &name)
+Address Scope::load_symbol(Atom name)
 {
     auto ptr = find_symbol(name);
     auto res = ptr ? ptr : load_builtin(name);
 
     if (res)
     {
-        res->set_called_name(name);
         return res;
     }
     else
@@ -66,34 +149,89 @@ Address Scope::load_symbol(const String &name)
     }
 }
 
-const std::map<String, Address> &Scope::symbols() const
+void Scope::set_slot(Size slot, Address addr)
 {
-    return symbols_;
+    if (slot >= slots_.size())
+    {
+        slots_.resize(slot + 1);
+    }
+    if (addr)
+    {
+        addr->release();
+    }
+    Collector::shade(addr);
+    slots_[slot] = std::move(addr);
 }
 
-Address Scope::load_builtin(const String &name)
+void Scope::clear_slots()
 {
-    if (auto func = BuiltInFunctionObject::load_built_in_function(name))
+    slots_.clear();
+}
+
+Address Scope::find_local(Atom name, MemberCache *cache)
+{
+    if (cache)
     {
-        return std::make_shared<Variable>(func);
+        if (auto entry = cache->find(layout_))
+        {
+            return entry->addr;
+        }
     }
-    return nullptr;
+
+    auto find = symbols_.find(name);
+    if (find == nullptr)
+    {
+        return nullptr;
+    }
+
+    if (cache)
+    {
+        cache->insert({ layout_, *find });
+    }
+    return *find;
 }
 
-Address Scope::find_symbol(const String &name)
+const SymbolTable &Scope::symbols() const
 {
-    auto res = symbols_.find(name);
-    if (res != symbols_.end())
+    return symbols_;
+}
+
+void Scope::trace(Visitor &visitor)
+{
+    visitor.visit(pre_scope_);
+    symbols_.for_each([&visitor](Atom, const Address &addr)
+        {
+            visitor.visit(addr);
+        }
+    );
+    for (auto &addr : slots_)
     {
-        return res->second;
+        visitor.visit(addr);
     }
-    else if (pre_scope_)
+}
+
+Address Scope::load_builtin(Atom name)
+{
+    if (auto func = BuiltInFunctionObject::load_built_in_function(name))
     {
-        return pre_scope_->find_symbol(name);
+        return make_pooled<Variable>(func);
     }
-    else
+    return nullptr;
+}
+
+/**
+ * scopes are usually shallow,
+ *  so the chain is walked without recursion
+*/
+Address Scope::find_symbol(Atom name)
+{
+    for (auto scope = this; scope; scope = scope->pre_scope_.get())
     {
-        return nullptr;
+        if (auto find = scope->symbols_.find(name))
+        {
+            return *find;
+        }
     }
+    return nullptr;
 }
 }
@@ -1,38 +1,216 @@
 #ifndef __ANOLE_RUNTIME_SCOPE_HPP__
 #define __ANOLE_RUNTIME_SCOPE_HPP__
 
+#include "atom.hpp"
+#include "pool.hpp"
 #include "variable.hpp"
 #include "allocator.hpp"
 
-#include <map>
+#include <vector>
 
 namespace anole
 {
+class NativeMethod;
+
+/**
+ * symbols of scopes are kept in an open-addressing table keyed by atoms,
+ *  symbols are replaced but never removed
+*/
+class SymbolTable
+{
+  public:
+    Address *find(Atom atom) noexcept
+    {
+        if (entries_.empty())
+        {
+            return nullptr;
+        }
+
+        auto mask = entries_.size() - 1;
+        for (auto i = hash(atom) & mask; ; i = (i + 1) & mask)
+        {
+            auto &entry = entries_[i];
+            if (entry.atom == atom)
+            {
+                return &entry.addr;
+            }
+            else if (entry.atom == 0)
+            {
+                return nullptr;
+            }
+        }
+    }
+
+    // the address of the symbol, which is empty if it's new
+    Address &insert(Atom atom);
+
+    Size size() const noexcept
+    {
+        return size_;
+    }
+
+    template<typename F>
+    void for_each(F &&func) const
+    {
+        for (auto &entry : entries_)
+        {
+            if (entry.atom)
+            {
+                func(entry.atom, entry.addr);
+            }
+        }
+    }
+
+  private:
+    struct Entry
+    {
+        Atom atom = 0;
+        Address addr;
+    };
+
+    static Size hash(Atom atom) noexcept
+    {
+        return (atom * 0x9E3779B97F4A7C15) >> 32;
+    }
+
+    void grow();
+
+  private:
+    std::vector<Entry, PoolAllocator<Entry>> entries_;
+    Size size_ = 0;
+};
+
+/**
+ * the inline cache of one LoadMember keeps where the member is,
+ *  entries are keyed by layouts of scopes with addresses of members
+ *  or by shapes of instances with indices of fields
+ *
+ * layouts are unique and renewed when symbols of scopes are changed,
+ *  so stale entries never hit again
+*/
+class MemberCache
+{
+  public:
+    static constexpr Size kEntries = 4;
+
+    struct Entry
+    {
+        Size layout = 0;
+        Address addr;
+        Size index = 0;
+        const NativeMethod *method = nullptr;
+    };
+
+    Entry *find(Size layout) noexcept
+    {
+        for (auto &entry : entries_)
+        {
+            if (entry.layout == layout)
+            {
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+
+    void insert(Entry entry) noexcept
+    {
+        entries_[next_] = std::move(entry);
+        next_ = (next_ + 1) % kEntries;
+    }
+
+  private:
+    Entry entries_[kEntries];
+    Size next_ = 0;
+};
+
 class Scope
 {
     friend class Collector;
 
+  public:
+    // layouts of scopes and shapes share one space of ids
+    static Size new_layout() noexcept;
+
+    /**
+     * definitions of symbols with the name in all scopes so far,
+     *  which only grow, so loads of builtins and globals
+     *  quickened with the count stay valid until it changes
+    */
+    static Size definitions(Atom name) noexcept;
+
   public:
     Scope() noexcept;
     Scope(SPtr<Scope> pre_scope) noexcept;
 
+    /**
+     * forks of scopes are used to resume continuations,
+     *  they see variables of the forked scope by pre
+     *  but stand for the same level for slots
+    */
+    static SPtr<Scope> fork(const SPtr<Scope> &scope);
+
     SPtr<Scope> &pre();
 
-    Address create_symbol(const String &name);
-    void create_symbol(const String &name, Object *);
-    void create_symbol(const String &name, Address value);
+    /**
+     * the scope at the lexical level above,
+     *  which is the same as pre except for forks
+    */
+    Scope *lexical_pre() noexcept
+    {
+        auto scope = pre_scope_.get();
+        for (auto forks = forks_; forks-- && scope;)
+        {
+            scope = scope->pre_scope_.get();
+        }
+        return scope;
+    }
+
+    /**
+     * slots hold variables resolved by the resolver,
+     *  variables in slots are also declared by names,
+     *  so empty slots can fall back to the lookup by names
+    */
+    Address *find_slot(Size slot) noexcept
+    {
+        if (slot < slots_.size() && slots_[slot])
+        {
+            return &slots_[slot];
+        }
+        return nullptr;
+    }
+    void set_slot(Size slot, Address addr);
+    void clear_slots();
 
-    Address load_symbol(const String &name);
+    Address create_symbol(Atom name);
+    void create_symbol(Atom name, Value value);
+    void create_symbol(Atom name, Address value);
 
-    const std::map<String, Address> &symbols() const;
+    Address load_symbol(Atom name);
+    // find the symbol in this scope and scopes above without creating it
+    Address find_symbol(Atom name);
+
+    // find the symbol only in this scope, using the cache if given
+    Address find_local(Atom name, MemberCache *cache = nullptr);
+
+    const SymbolTable &symbols() const;
+
+    // visit the scope above and objects held by variables
+    void trace(Visitor &visitor);
 
   private:
-    Address load_builtin(const String &name);
-    Address find_symbol(const String &name);
+    static void define(Atom name);
+
+    Address load_builtin(Atom name);
 
   private:
     SPtr<Scope> pre_scope_;
-    std::map<String, Address> symbols_;
+    SymbolTable symbols_;
+    std::vector<Address, PoolAllocator<Address>> slots_;
+    // count of forks skipped by lexical_pre
+    Size forks_;
+    Size layout_;
+    uint32_t mark_;
 };
 }
 
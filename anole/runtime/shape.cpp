@@ -0,0 +1,39 @@
+#include "runtime.hpp"
+
+namespace anole
+{
+Shape::Shape()
+  : id_(Scope::new_layout())
+{
+    // ...
+}
+
+Shape::Shape(const Shape &parent, Atom name)
+  : id_(Scope::new_layout())
+  , indices_(parent.indices_)
+{
+    indices_[name] = parent.size();
+}
+
+Shape *Shape::root()
+{
+    static Shape root;
+    return &root;
+}
+
+Size Shape::find(Atom name) const
+{
+    auto find = indices_.find(name);
+    return find == indices_.end() ? kNotFound : find->second;
+}
+
+Shape *Shape::add(Atom name)
+{
+    auto &shape = transitions_[name];
+    if (!shape)
+    {
+        shape.reset(new Shape(*this, name));
+    }
+    return shape.get();
+}
+}
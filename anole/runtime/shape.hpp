@@ -0,0 +1,52 @@
+#ifndef __ANOLE_RUNTIME_SHAPE_HPP__
+#define __ANOLE_RUNTIME_SHAPE_HPP__
+
+#include "atom.hpp"
+
+#include <map>
+#include <memory>
+
+namespace anole
+{
+/**
+ * shapes describe where fields of instances are,
+ *  instances adding the same fields in the same order share one shape
+ *
+ * shapes form a tree from the root by adding fields,
+ *  they are never changed and live as long as the program
+*/
+class Shape
+{
+  public:
+    static constexpr Size kNotFound = Size(-1);
+
+    static Shape *root();
+
+    Size id() const noexcept
+    {
+        return id_;
+    }
+
+    Size size() const noexcept
+    {
+        return indices_.size();
+    }
+
+    // the index of the field or kNotFound
+    Size find(Atom name) const;
+
+    // the shape with the field added at the end
+    Shape *add(Atom name);
+
+  private:
+    Shape();
+    Shape(const Shape &parent, Atom name);
+
+  private:
+    Size id_;
+    std::map<Atom, Size> indices_;
+    std::map<Atom, std::unique_ptr<Shape>> transitions_;
+};
+}
+
+#endif
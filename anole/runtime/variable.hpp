@@ -1,6 +1,8 @@
 #ifndef __ANOLE_RUNTIME_VARIABLE_HPP__
 #define __ANOLE_RUNTIME_VARIABLE_HPP__
 
+#include "collector.hpp"
+#include "../objects/value.hpp"
 #include "../objects/object.hpp"
 
 #include <memory>
@@ -9,35 +11,109 @@ namespace anole
 {
 class Variable
 {
+    friend class Visitor;
+    friend class Collector;
+
   public:
-    Variable() noexcept(noexcept(String())) : ptr_(nullptr) {}
-    Variable(Object *ptr) noexcept(noexcept(String())) : ptr_(ptr) {}
+    Variable() noexcept : value_(), owner_(nullptr), remembered_(0) {}
+    Variable(Value value, Object *owner = nullptr)
+      : value_(value), owner_(owner), remembered_(0)
+    {
+        write_barrier();
+    }
+    Variable(const Variable &) = delete;
+
+    ~Variable()
+    {
+        if (remembered_)
+        {
+            Collector::forget(this);
+        }
+    }
 
     Variable &operator=(Object *) = delete;
 
-    void bind(Object *ptr) noexcept
+    void bind(Value value)
     {
-        ptr_ = ptr;
+        value_ = value;
+        write_barrier();
     }
 
-    Object *ptr() const noexcept
+    Value value() const noexcept
     {
-        return ptr_;
+        return value_;
     }
 
-    void set_called_name(String called_name)
+    /**
+     * the immediate value will be boxed and rebound
+     *  so that the object is the same in later uses
+    */
+    Object *ptr()
     {
-        called_name_ = std::move(called_name);
+        if (!value_.is_object())
+        {
+            value_ = value_.box();
+            write_barrier();
+        }
+        return value_.as_object();
     }
 
-    const String &called_name() const noexcept
+    /**
+     * the variable is on its own once it's shared
+     *  by a scope or a list other than its owner,
+     *  for the owner may die before it
+    */
+    void release()
+    {
+        if (owner_)
+        {
+            owner_ = nullptr;
+            write_barrier();
+        }
+    }
+
+    // the owner is moved by compaction
+    void relocate_owner(Object *from, Object *to) noexcept
+    {
+        if (owner_ == from)
+        {
+            owner_ = to;
+        }
+    }
+
+  private:
+    /**
+     * variables of lists, dicts and instances are owned by them,
+     *  and the owner is remembered if it's old and a young object is bound,
+     *  so young objects of dead young containers die with them
+     *
+     * other variables holding young objects are remembered,
+     *  they are roots of minor collections, for scopes are not traced
+     *
+     * and objects bound are shaded during incremental marking
+    */
+    void write_barrier()
     {
-      return called_name_;
+        if (auto obj = value_.heap_object())
+        {
+            if (owner_)
+            {
+                Collector::write_barrier(owner_, obj);
+                return;
+            }
+            if (obj->is_young() && !remembered_)
+            {
+                Collector::remember(this);
+            }
+            Collector::shade(obj);
+        }
     }
 
   private:
-    Object *ptr_;
-    String called_name_;
+    Value value_;
+    Object *owner_;
+    // the index in remembered variables plus one, see Collector
+    uint32_t remembered_;
 };
 } // namespace anole
 
@@ -35,7 +35,7 @@ struct Version
  *  for the temporary change after the last release
 */
 using Magic = Size;
-inline constexpr Magic theMagic = 2021'02'13;
+inline constexpr Magic theMagic = 2021'02'13'6;
 }
 
 #endif
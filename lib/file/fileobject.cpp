@@ -27,81 +27,83 @@ void __open(anole::Size n)
 
 namespace
 {
-std::map<anole::String, std::function<void(FileObject *)>>
-localBuiltinMethods
+const anole::NativeMethods localBuiltinMethods
 {
-    {"good", [](FileObject *obj)
-        {
-            anole::theCurrContext->push(obj->file().good() ? anole::BoolObject::the_true() : anole::BoolObject::the_false());
-        }
-    },
-    {"eof", [](FileObject *obj)
-        {
-            anole::theCurrContext->push(obj->file().eof() ? anole::BoolObject::the_true() : anole::BoolObject::the_false());
-        }
-    },
-    {"close", [](FileObject *obj)
-        {
-            obj->file().close();
-        }
-    },
-    {"flush", [](FileObject *obj)
-        {
-            obj->file().flush();
-        }
-    },
-    {"read", [](FileObject *obj)
-        {
-            anole::theCurrContext->push(
-                anole::Allocator<anole::Object>::alloc<anole::StringObject>(
-                    anole::String(1, obj->file().get())
-                )
-            );
-        }
-    },
-    {"readline", [](FileObject *obj)
-        {
-            anole::String line;
-            std::getline(obj->file(), line);
-            anole::theCurrContext->push(anole::Allocator<anole::Object>::
-                alloc<anole::StringObject>(line)
-            );
-        }
-    },
-    {"write", [](FileObject *obj)
-        {
-            const auto &str
-                = dynamic_cast<anole::StringObject *>(anole::theCurrContext->pop_ptr())->to_str()
-            ;
-            obj->file().write(str.c_str(), str.size());
-        }
-    },
-    {"tellg", [](FileObject *obj)
-        {
-            anole::theCurrContext->push(anole::Allocator<anole::Object>::
-                alloc<anole::IntegerObject>(
-                    obj->file().tellg()
-                )
-            );
-        }
-    },
-    {"tellp", [](FileObject *obj)
-        {
-            anole::theCurrContext->push(anole::Allocator<anole::Object>::
-                alloc<anole::IntegerObject>(
-                    obj->file().tellp()
-                )
-            );
-        }
-    },
-    {"seekg", [](FileObject *obj)
-        {
-            obj->file().seekg(dynamic_cast<anole::IntegerObject *>(anole::theCurrContext->pop_ptr())->value());
-        }
-    },
-    {"seekp", [](FileObject *obj)
-        {
-            obj->file().seekp(dynamic_cast<anole::IntegerObject *>(anole::theCurrContext->pop_ptr())->value());
+    anole::Object::add_object_type("file"),
+    {
+        {"good", [](FileObject *obj)
+            {
+                anole::theCurrContext->push(obj->file().good() ? anole::BoolObject::the_true() : anole::BoolObject::the_false());
+            }
+        },
+        {"eof", [](FileObject *obj)
+            {
+                anole::theCurrContext->push(obj->file().eof() ? anole::BoolObject::the_true() : anole::BoolObject::the_false());
+            }
+        },
+        {"close", [](FileObject *obj)
+            {
+                obj->file().close();
+            }
+        },
+        {"flush", [](FileObject *obj)
+            {
+                obj->file().flush();
+            }
+        },
+        {"read", [](FileObject *obj)
+            {
+                anole::theCurrContext->push(
+                    anole::Allocator<anole::Object>::alloc<anole::StringObject>(
+                        anole::String(1, obj->file().get())
+                    )
+                );
+            }
+        },
+        {"readline", [](FileObject *obj)
+            {
+                anole::String line;
+                std::getline(obj->file(), line);
+                anole::theCurrContext->push(anole::Allocator<anole::Object>::
+                    alloc<anole::StringObject>(line)
+                );
+            }
+        },
+        {"write", [](FileObject *obj)
+            {
+                const auto &str
+                    = dynamic_cast<anole::StringObject *>(anole::theCurrContext->pop_ptr())->to_str()
+                ;
+                obj->file().write(str.c_str(), str.size());
+            }
+        },
+        {"tellg", [](FileObject *obj)
+            {
+                anole::theCurrContext->push(anole::Allocator<anole::Object>::
+                    alloc<anole::IntegerObject>(
+                        obj->file().tellg()
+                    )
+                );
+            }
+        },
+        {"tellp", [](FileObject *obj)
+            {
+                anole::theCurrContext->push(anole::Allocator<anole::Object>::
+                    alloc<anole::IntegerObject>(
+                        obj->file().tellp()
+                    )
+                );
+            }
+        },
+        {"seekg", [](FileObject *obj)
+            {
+                obj->file().seekg(dynamic_cast<anole::IntegerObject *>(anole::theCurrContext->pop_ptr())->value());
+            }
+        },
+        {"seekp", [](FileObject *obj)
+            {
+                obj->file().seekp(dynamic_cast<anole::IntegerObject *>(anole::theCurrContext->pop_ptr())->value());
+            }
         }
     }
 };
@@ -141,25 +143,6 @@ FileObject::FileObject(const anole::String &path, int64_t mode)
     file_.open(path, mod);
 }
 
-anole::Address FileObject::load_member(const anole::String &name)
-{
-    auto method = localBuiltinMethods.find(name);
-    if (method != localBuiltinMethods.end())
-    {
-        return std::make_shared<anole::Variable>(
-            anole::Allocator<anole::Object>::alloc<anole::BuiltInFunctionObject>(
-                [this, &func = method->second]
-                (anole::Size) mutable
-                {
-                    func(this);
-                },
-                this
-            )
-        );
-    }
-    return Object::load_member(name);
-}
-
 std::fstream &FileObject::file()
 {
     return file_;
@@ -10,7 +10,6 @@ class FileObject
 {
   public:
     FileObject(const anole::String &, std::int64_t mode);
-    anole::Address load_member(const anole::String &name) override;
 
     std::fstream &file();
 
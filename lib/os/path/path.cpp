@@ -57,16 +57,18 @@ void __is_directory(anole::Size n)
 
 namespace
 {
-std::map<anole::String, std::function<void(PathObject *)>>
-localBuiltinMethods
+const anole::NativeMethods localBuiltinMethods
 {
-    {"is_directory", [](PathObject *obj)
-        {
-            anole::theCurrContext->push(
-                fs::is_directory(obj->path())
-                ? anole::BoolObject::the_true()
-                : anole::BoolObject::the_false()
-            );
+    anole::Object::add_object_type("path"),
+    {
+        {"is_directory", [](PathObject *obj)
+            {
+                anole::theCurrContext->push(
+                    fs::is_directory(obj->path())
+                    ? anole::BoolObject::the_true()
+                    : anole::BoolObject::the_false()
+                );
+            }
         }
     }
 };
@@ -79,25 +81,6 @@ PathObject::PathObject(fs::path path)
     // ...
 }
 
-anole::Address PathObject::load_member(const anole::String &name)
-{
-    auto method = localBuiltinMethods.find(name);
-    if (method != localBuiltinMethods.end())
-    {
-        return std::make_shared<anole::Variable>(
-            anole::Allocator<anole::Object>::alloc<anole::BuiltInFunctionObject>(
-                [this, &func = method->second]
-                (anole::Size) mutable
-                {
-                    func(this);
-                },
-                this
-            )
-        );
-    }
-    return anole::Object::load_member(name);
-}
-
 anole::String PathObject::to_str()
 {
     return path_.string();
@@ -12,7 +12,6 @@ class PathObject : public anole::Object
   public:
     PathObject(std::filesystem::path path);
 
-    anole::Address load_member(const anole::String &name) override;
     anole::String to_str() override;
 
     std::filesystem::path &path();
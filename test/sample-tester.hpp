@@ -6,6 +6,7 @@
 #include <gtest/gtest.h>
 
 #include <cstdio>
+#include <fstream>
 #include <sstream>
 #include <iostream>
 #include <filesystem>
@@ -24,7 +25,16 @@ inline String execute(const String &input)
     Parser parser{ss, "<test>"};
     while (auto stmt = parser.gen_statement())
     {
-        stmt->codegen(*code);
+        Block::StmtList statements;
+        statements.push_back(std::move(stmt));
+        Optimizer::optimize(statements);
+        auto from = code->size();
+        for (auto &stmt : statements)
+        {
+            stmt->codegen(*code);
+        }
+        Resolver::resolve(*code, from);
+        Peephole::optimize(*code, from);
         Context::execute();
     }
   #ifdef _DEBUG
@@ -450,4 +460,1104 @@ prints(a, b);
 R"(1 2 3 4 5 6 )");
 }
 
+
+TEST(Sample, IntegerOutOfImmediateRange)
+{
+    ASSERT_EQ(execute(
+// input
+R"(
+@a: 140737488355327;
+@b: a + 1;
+println(b);
+println(b - 1 = a);
+println((b - 1) is a);
+println(a * 65536);
+println(-b);
+println(1.5 + 2.25);
+)"),
+
+// output
+R"(140737488355328
+true
+true
+9223372036854710272
+-140737488355328
+3.750000
+)");
+}
+
+
+TEST(Sample, Superinstructions)
+{
+    ASSERT_EQ(execute(
+// input
+R"(
+@x: delay 1 + 2;
+@y: 4;
+println(x + y);
+@c: true;
+println((c ? 10, y) + y);
+c: false;
+println((c ? 10, y) + y);
+@l: [1];
+l.push(2);
+println(l);
+)"),
+
+// output
+R"(7
+14
+8
+[1, 2]
+)");
+}
+
+TEST(Sample, SlotResolution)
+{
+    ASSERT_EQ(execute(
+// input
+R"(
+@counter() {
+    @n: 0;
+    return @() { n: n + 1; return n; };
+}
+@next: counter();
+next(); next();
+println(next());
+@sum() {
+    @i: 0;
+    @s: 0;
+    while i < 3 {
+        if 0 < i {
+            s: s + later;
+        }
+        @later: i * 10;
+        i: i + 1;
+    }
+    return s;
+}
+println(sum());
+@m: 1;
+@outer() {
+    @read() { return m; }
+    @m: 2;
+    return read();
+}
+println(outer());
+@dynamic(a) {
+    @b: a + 1;
+    return eval("a + b");
+}
+println(dynamic(1));
+)"),
+
+// output
+R"(3
+10
+2
+3
+)");
+}
+
+
+TEST(Sample, MissingParameters)
+{
+    // parameters of resolved functions are stored to slots
+    auto error_of = [](const String &input) -> String
+    {
+        auto backup = std::cout.rdbuf();
+        try
+        {
+            execute(input);
+        }
+        catch (const RuntimeError &e)
+        {
+            std::cout.rdbuf(backup);
+            return e.what();
+        }
+        return "";
+    };
+
+    EXPECT_NE(error_of("@f(a, b) { return a; }\nprintln(f(1));").find("missing the parameter named 'b'"), String::npos);
+    EXPECT_NE(error_of("@g(a, &b) { return a; }\nprintln(g(1));").find("missing the parameter named 'b'"), String::npos);
+    EXPECT_NE(error_of("@h(a, b) { return @() { return a + b; }; }\nprintln(h(1));").find("missing the parameter named 'b'"), String::npos);
+}
+
+TEST(Sample, MemberCache)
+{
+    ASSERT_EQ(execute(
+// input
+R"(
+@A: class {
+    __init__(self) {
+        self.v: 1;
+    };
+    get(self) {
+        return self.v;
+    };
+};
+@a: A();
+@b: A();
+@res: 0;
+@i: 0;
+while i < 3 {
+    res: res + a.v + b.get();
+    a.v: a.v + 1;
+    i: i + 1;
+}
+println(res);
+@objs: [a, b, A(), a];
+@total: 0;
+foreach objs as o {
+    i > 2 ? o.w: 10, none;
+    total: total + o.w;
+}
+println(total);
+println(a.get());
+)"),
+
+// output
+R"(9
+40
+4
+)");
+}
+
+TEST(Sample, InstanceShapes)
+{
+    ASSERT_EQ(execute(
+// input
+R"(
+@Counter: class {
+    count: 0;
+    tags: [];
+    __init__(self, step) {
+        self.step: step;
+    };
+    inc(self) {
+        self.count: self.count + self.step;
+        return self;
+    };
+};
+@a: Counter(1);
+@b: Counter(10);
+a.inc().inc();
+b.inc();
+println(a.count);
+println(b.count);
+println(Counter.count);
+a.tags.push(1);
+println(b.tags);
+@Named: class(Counter) {
+    __init__(self, name) {
+        self.name: name;
+        self.step: 2;
+    };
+    show(self) {
+        return self.name + ":" + str(self.count);
+    };
+};
+@n: Named("n");
+println(n.inc().show());
+n.hook: @(self): self.step;
+println(n.hook());
+)"),
+
+// output
+R"(2
+10
+0
+[1]
+n:2
+2
+)");
+}
+
+
+TEST(Sample, NativeMethods)
+{
+    ASSERT_EQ(execute(
+// input
+R"(
+@l: [1, 2];
+l.push(3);
+println(l.size());
+@push: l.push;
+push(4);
+println(l);
+println(l.pop());
+@d: dict {"a" => 1, "b" => 2, "size" => 10};
+println(d.size());
+println(d.a);
+@n: 42;
+println(n.to_str() + "!");
+@objs: [[], "ab", dict {}];
+foreach objs as o {
+    println(o.size());
+};
+)"),
+
+// output
+R"(3
+[1, 2, 3, 4]
+4
+3
+1
+42!
+0
+2
+0
+)");
+}
+
+
+TEST(Sample, Quickening)
+{
+    ASSERT_EQ(execute(
+// input
+R"(
+@add: @(a, b): a + b;
+@lt: @(a, b): a < b;
+@i: 0;
+@sum: 0;
+while i < 40 {
+    sum: sum + add(i, i * 2);
+    lt(i, 1) ? i, 0;
+    i: i + 1;
+};
+println(sum);
+println(add(1.5, 2.25));
+println(add("a", "b"));
+println(lt(2.5, 1.5));
+println(add(1 << 40, 1 << 40));
+@n: 0.5;
+while n < 8.0 {
+    n: n * 2.0;
+};
+println(n);
+)"),
+
+// output
+R"(2340
+3.750000
+ab
+false
+2199023255552
+8.000000
+)");
+}
+
+
+TEST(Sample, UnboundNames)
+{
+    auto backup = std::cout.rdbuf();
+    auto error_of = [backup](const String &input) -> String
+    {
+        try
+        {
+            execute(input);
+        }
+        catch (const RuntimeError &e)
+        {
+            std::cout.rdbuf(backup);
+            return e.what();
+        }
+        return "";
+    };
+
+    auto unbound = [](const String &name)
+    {
+        return "var named " + name + " doesn't reference to any object";
+    };
+
+    EXPECT_NE(error_of("@a: 1;\nprintln(a + zz);").find(unbound("zz")), String::npos);
+    EXPECT_NE(error_of("@k: 1;\nprintln(nope + k);").find(unbound("nope")), String::npos);
+    EXPECT_NE(error_of("@f: @(x) { return x + qq; };\nf(1);").find(unbound("qq")), String::npos);
+    EXPECT_NE(error_of("@C: class { __init__(self) {}; };\nprintln(C().w + 1);").find(unbound("w")), String::npos);
+
+    // names are only searched in the function, and left out if not found
+    auto nameless = "var doesn't reference to any object";
+    EXPECT_NE(error_of("@d: dict {};\n@g(): d[\"k\"] + 1;\ng();").find(nameless), String::npos);
+    EXPECT_NE(error_of("@o: dict {};\n@n: o.size();\n@g(): o[\"k\"] + 1;\ng();").find(nameless), String::npos);
+}
+
+
+TEST(Sample, SymbolTables)
+{
+    ASSERT_EQ(execute(
+// input
+R"(
+@i: 0;
+while i < 40 {
+    eval("v" + str(i) + ": " + str(i * i));
+    i: i + 1;
+};
+println(v0 + v13 + v39);
+@Base: class {
+    a: 1;
+    b: 2;
+    sum(self) { return self.a + self.b; };
+};
+@Derived: class(Base) {
+    b: 20;
+    __init__(self) {};
+};
+println(Derived().sum());
+@E: enum { X, Y, Z };
+println(E.Z);
+)"),
+
+// output
+R"(1690
+21
+2
+)");
+}
+
+TEST(Sample, GlobalLoads)
+{
+    ASSERT_EQ(execute(
+// input
+R"(
+@show(x) { return str(x); };
+@i: 0;
+while i < 3 {
+    println(show(i));
+    i: i + 1;
+};
+@str(x) { return "s"; };
+println(show(5));
+@get() { return g; };
+@g: 1;
+println(get());
+println(get());
+g: 2;
+println(get());
+@h: 10;
+@&g: h;
+println(get());
+h: 11;
+println(get());
+)"),
+
+// output
+R"(0
+1
+2
+s
+1
+1
+2
+10
+11
+)");
+}
+
+TEST(Sample, DeepLists)
+{
+    ASSERT_EQ(execute(
+// input
+R"(
+@id(x) { return x; };
+@head: [0];
+@cur: head;
+@i: 1;
+while i < 100000 {
+    @next: [i];
+    cur.push(next);
+    cur: id(next);
+    i: i + 1;
+};
+@sum: 0;
+cur: head;
+while cur.size() = 2 {
+    sum: sum + cur.front();
+    cur: cur.back();
+};
+println(sum + cur.front());
+)"),
+
+// output
+R"(4999950000
+)");
+}
+
+TEST(Sample, Generations)
+{
+    ASSERT_EQ(execute(
+// input
+R"(
+@id(x) { return x; };
+@old: [];
+@keys: dict {};
+@i: 0;
+while i < 30000 {
+    old.push([i]);
+    keys[id([i])]: i;
+    i: i + 1;
+};
+@j: 0;
+while j < 30000 {
+    old[j]: id([j * 2]);
+    j: j + 1;
+};
+@sum: 0;
+j: 0;
+while j < 30000 {
+    sum: sum + old[j][0];
+    j: j + 1;
+};
+println(sum);
+println(keys.size());
+)"),
+
+// output
+R"(899970000
+30000
+)");
+}
+
+
+
+TEST(Sample, YoungGarbage)
+{
+    // young objects in dead young lists and dicts die in minor collections
+    auto heap = Collector::heap_stats();
+    ASSERT_EQ(execute(
+// input
+R"(
+@C: class { __init__(self, x) { self.x: [x]; }; };
+@i: 0;
+while i < 200000 {
+    @l: [[i], [i]];
+    @d: dict { "k" => [i] };
+    @c: C(i);
+    i: i + 1;
+};
+println(i);
+)"),
+
+// output
+R"(200000
+)");
+    auto now = Collector::heap_stats();
+    EXPECT_GT(now.minors, heap.minors);
+    EXPECT_EQ(now.majors, heap.majors);
+}
+
+TEST(Sample, IncrementalMarking)
+{
+    Collector::set_generational(false);
+    Collector::set_budget(50, 0);
+    auto pauses = Collector::pause_stats().count;
+
+    auto output = execute(
+// input
+R"(
+@id(x) { return x; };
+@a: [];
+@b: [];
+@d: dict {};
+@i: 0;
+while i < 20000 {
+    a.push([i]);
+    i: i + 1;
+};
+i: 0;
+while i < 100000 {
+    id([i]);
+    i: i + 1;
+};
+@j: 0;
+while j < 20000 {
+    @&x: a.pop();
+    d[j % 100]: id([x[0]]);
+    b.push(id(x));
+    id([j]);
+    j: j + 1;
+};
+@sum: 0;
+j: 0;
+while j < 20000 {
+    sum: sum + b[j][0];
+    j: j + 1;
+};
+println(sum);
+sum: 0;
+j: 0;
+while j < 100 {
+    sum: sum + d[j][0];
+    j: j + 1;
+};
+println(sum);
+)");
+
+    Collector::set_generational(true);
+    Collector::set_budget(10000, 0);
+
+    ASSERT_EQ(output,
+// output
+R"(199990000
+4950
+)");
+    ASSERT_GT(Collector::pause_stats().count, pauses + 10);
+}
+
+
+TEST(Sample, ParallelMarking)
+{
+    Collector::set_threads(3);
+
+    auto output = execute(
+// input
+R"(
+@id(x) { return x; };
+@old: [];
+@keys: dict {};
+@round: 0;
+while round < 5 {
+    @i: 0;
+    while i < 20000 {
+        old.push([[i], id([i])]);
+        keys[id([i])]: [i];
+        i: i + 1;
+    };
+    @sum: 0;
+    i: 0;
+    while i < 20000 {
+        sum: sum + old.pop_front()[1][0];
+        i: i + 1;
+    };
+    println(sum);
+    round: round + 1;
+};
+println(keys.size());
+)");
+
+    Collector::set_threads(0);
+
+    ASSERT_EQ(output,
+// output
+R"(199990000
+199990000
+199990000
+199990000
+199990000
+20000
+)");
+}
+
+TEST(Sample, GCTriggering)
+{
+    ASSERT_EQ(execute(
+// input
+R"(
+@before: __gc_stats();
+@i: 0;
+while i < 100000 {
+    @l: [i];
+    i: i + 1;
+};
+@after: __gc_stats();
+println(after["minors"] > before["minors"]);
+
+__gc_enable(false);
+println(__gc_enabled());
+i: 0;
+while i < 100000 {
+    @l: [i];
+    i: i + 1;
+};
+println(__gc_stats()["minors"] = after["minors"]);
+__gc_enable(true);
+
+@keep: [];
+i: 0;
+while i < 1000 {
+    keep.push([i]);
+    i: i + 1;
+};
+__gc_collect();
+@stats: __gc_stats();
+println(stats["majors"] > after["majors"]);
+println(stats["types"]["list"] > 1000 * 16);
+println(stats["live"] <= stats["mapped"]);
+println(stats["pauses"].size());
+)"),
+
+// output
+R"(true
+false
+true
+true
+true
+true
+20
+)");
+}
+
+TEST(Sample, Compaction)
+{
+    ASSERT_EQ(execute(
+// input
+R"(
+@A: class {
+    __init__(self, v) {
+        self.v: v;
+    };
+};
+@keep: [];
+@d: dict {};
+@i: 0;
+while i < 20000 {
+    @s: "s" + str(i);
+    @l: [s, i, A(i)];
+    if i % 10 = 0 {
+        keep.push(l);
+        d[l[2]]: s;
+        d[s]: l;
+    }
+    i: i + 1;
+};
+@sum: 0;
+@ok: true;
+foreach keep as l {
+    if l[1] = 10000 {
+        __gc_collect();
+        __gc_compact();
+    }
+    sum: sum + l[1] + l[2].v;
+    if d[l[2]] != l[0] { ok: false; }
+    if d[l[0]][1] != l[1] { ok: false; }
+};
+@stats: __gc_stats();
+println(stats["compactions"] > 0);
+println(stats["moved"] > 0);
+println(sum);
+println(ok);
+println(d.size());
+)"),
+
+// output
+R"(true
+true
+39980000
+true
+4000
+)");
+}
+
+TEST(Sample, FramePool)
+{
+    ASSERT_EQ(execute(
+// input
+R"(
+@counter(start) {
+    @n: start;
+    return @() {
+        n: n + 1;
+        return n;
+    };
+}
+@counters: [];
+@i: 0;
+while i < 100 {
+    counters.push(counter(i * 10));
+    i: i + 1;
+};
+@sum(n): (n = 0) ? 0, n + sum(n - 1);
+println(sum(1000));
+counters[3]();
+println(counters[3]());
+println(counters[99]());
+@f: counter(0);
+f();
+println(sum(10) + f());
+)"),
+
+// output
+R"(500500
+32
+991
+57
+)");
+}
+
+TEST(Sample, DefaultConstructor)
+{
+    ASSERT_EQ(execute(
+// input
+R"(
+@A: class {
+    get(self) { return 1; };
+};
+@a: A();
+println(a.get());
+println(A().get() + A().get());
+)"),
+
+// output
+R"(1
+2
+)");
+}
+
+TEST(Sample, GreaterComparisons)
+{
+    ASSERT_EQ(execute(
+// input
+R"(
+@a: 2;
+@b: 3;
+println([a > a, a >= a, b > a, a > b, b >= a, a >= b]);
+println([2.5 > 2.5, 2.5 >= 2.5, "b" > "a"]);
+)"),
+
+// output
+R"([false, true, true, false, true, false]
+[false, true, true]
+)");
+}
+
+TEST(Sample, FloatConstants)
+{
+    ASSERT_EQ(execute(
+// input
+R"(
+@a: 1.0000001;
+@b: 1.0000002;
+println([a = b, a < b, 0.1234561 < 0.1234564]);
+)"),
+
+// output
+R"([false, true, true]
+)");
+}
+
+TEST(Sample, TailCalls)
+{
+    ASSERT_EQ(execute(
+// input
+R"(
+@loop(n, acc) {
+    if n = 0 {
+        return acc;
+    }
+    return loop(n - 1, acc + n);
+}
+println(loop(200000, 0));
+@even(n): (n = 0) ? true, odd(n - 1);
+@odd(n): (n = 0) ? false, even(n - 1);
+println(even(100001));
+@C: class {
+    __init__(self) { self.n: 0; };
+    count(self, k) {
+        if k = 0 { return self.n; }
+        self.n: self.n + 1;
+        return self.count(k - 1);
+    };
+};
+println(C().count(100000));
+@f(x): x + 1;
+@g(x) { return f(x) * 2; }
+println(g(3));
+@h(x) { return str(x); }
+println(h(42));
+@args(...xs) { return loop(xs...); }
+println(args(10, 0));
+@D: class {
+    m(self) { return self.n(); };
+    n(self) { return 1; };
+};
+println(D().m());
+)"),
+
+// output
+R"(20000100000
+false
+100000
+8
+42
+55
+1
+)");
+
+    // frames replaced by tail calls don't show in tracebacks,
+    //  and without them the traceback would have 66 callers
+    auto backup = std::cout.rdbuf();
+    String error;
+    try
+    {
+        execute("@down(n) {\n    if n = 0 { return n + \"a\"; }\n    return down(n - 1);\n}\ndown(1000);");
+    }
+    catch (const RuntimeError &e)
+    {
+        std::cout.rdbuf(backup);
+        error = e.what();
+    }
+    Size lines = 0;
+    for (auto pos = error.find("running at"); pos != String::npos; pos = error.find("running at", pos + 1))
+    {
+        ++lines;
+    }
+    EXPECT_NE(error.find("no match method"), String::npos);
+    EXPECT_EQ(lines, 2);
+}
+
+TEST(Sample, ConstantFolding)
+{
+    ASSERT_EQ(execute(
+// input
+R"(
+@f(n) {
+    @l: [1, [2, 3], dict {"a" => 1, 2 => [4]}];
+    l[1][0]: l[1][0] + n;
+    return l;
+}
+println(f(10));
+println(f(20));
+println(1 + 2 * 3 - -4);
+println("a" + "b" + "c");
+println(2 > 2 or 2 >= 2);
+println(~1 << 4);
+println(0.5 + 0.25 = 0.75);
+if false {
+    println("dead");
+} elif 1 > 0 {
+    println("taken");
+} else {
+    println("dead");
+}
+@i: 0;
+while true {
+    i: i + 1;
+    if i > 3 { break; }
+}
+println(i);
+while false { println("dead"); }
+@g() { return 0 ? "dead", "ques"; println("dead"); }
+println(g());
+)"),
+
+// output
+R"([1, [12, 3], { 2 => [4], a => 1 }]
+[1, [22, 3], { 2 => [4], a => 1 }]
+11
+abc
+true
+-32
+true
+taken
+4
+ques
+)");
+}
+
+
+TEST(Sample, NoneConditions)
+{
+    // none has no truth, folding it mustn't hide the error
+    auto error_of = [](const String &input) -> String
+    {
+        auto backup = std::cout.rdbuf();
+        try
+        {
+            execute(input);
+        }
+        catch (const RuntimeError &e)
+        {
+            std::cout.rdbuf(backup);
+            return e.what();
+        }
+        return "";
+    };
+
+    for (auto input : {"if none { println(1); }", "while none { break; }", "println(not none);", "println(none ? 1, 2);"})
+    {
+        auto error = error_of(input);
+        Optimizer::set_enabled(false);
+        EXPECT_EQ(error, error_of(input));
+        Optimizer::set_enabled(true);
+        EXPECT_NE(error.find("cannot translate to bool"), String::npos);
+    }
+}
+
+TEST(Sample, Jit)
+{
+    Jit::set_enabled(true);
+    Jit::set_threshold(2);
+
+    EXPECT_EQ(execute(
+// input
+R"(
+@fib(n) {
+    if n < 2 { return n; }
+    return fib(n - 1) + fib(n - 2);
+}
+println(fib(20));
+@counter() {
+    @n: 0;
+    return @() {
+        n: n + 1;
+        return n;
+    };
+}
+@c: counter();
+@i: 0;
+@s: 0.0;
+@l: [];
+while i < 1000 {
+    s: s + 0.5;
+    if i % 100 = 0 {
+        l.push(c());
+    }
+    i: i + 1;
+};
+println(s);
+println(l);
+@loop(n, acc) {
+    if n = 0 { return acc; }
+    return loop(n - 1, acc + n);
+}
+println(loop(100000, 0));
+@P: class {
+    __init__(self, x) { self.x: x; };
+    get(self) { return self.x; };
+};
+@sum: 0;
+foreach [1, 2, 3, 4, 5] as x {
+    sum: sum + P(x).get();
+};
+println(sum);
+@safe(f) {
+    @e: call_with_current_continuation(@(cont) {
+        f(cont);
+        return none;
+    });
+    return e;
+}
+@k: 0;
+while k < 10 {
+    if !(safe(@(cont) { if k % 3 = 0 { cont(k); } }) is none) {
+        print(k);
+    }
+    k: k + 1;
+};
+println("");
+)"),
+
+// output
+R"(6765
+500.000000
+[1, 2, 3, 4, 5, 6, 7, 8, 9, 10]
+5000050000
+15
+0369
+)");
+
+    // errors in native code are located as the interpreter does
+    auto error_of = [](const String &input) -> String
+    {
+        auto backup = std::cout.rdbuf();
+        try
+        {
+            execute(input);
+        }
+        catch (const RuntimeError &e)
+        {
+            std::cout.rdbuf(backup);
+            return e.what();
+        }
+        return "";
+    };
+    auto input = "@f(x): x + 1;\n@i: 0;\nwhile i < 5 { f(i); i: i + 1; };\nf(\"a\");";
+    auto error = error_of(input);
+    Jit::set_enabled(false);
+    EXPECT_EQ(error, error_of(input));
+    EXPECT_NE(error.find("no match method"), String::npos);
+
+    Jit::set_threshold(Jit::kDefaultThreshold);
+}
+
+
+TEST(Sample, Aot)
+{
+    namespace fs = std::filesystem;
+
+    auto dir = fs::temp_directory_path() / "anole-aot-test";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    std::ofstream{dir / "mod.anole"} << R"(
+@fib(n) {
+    if n < 2 { return n; }
+    return fib(n - 1) + fib(n - 2);
+}
+@sum(n) {
+    @s: 0;
+    @i: 0;
+    while i < n {
+        s: s + i;
+        i: i + 1;
+    };
+    return s;
+}
+@counter() {
+    @n: 0;
+    return @() {
+        n: n + 1;
+        return n;
+    };
+}
+@loop(n, acc) {
+    if n = 0 { return acc; }
+    return loop(n - 1, acc + n);
+}
+@inc(x): x + 1;
+@squares: [];
+foreach [1, 2, 3] as x {
+    squares.push(x * x);
+};
+)";
+
+    auto run = [&dir](const String &name)
+    {
+        return execute(
+            "use * from \"" + (dir / name).string() + "\";\n"
+            "println(fib(20));\n"
+            "println(sum(100000));\n"
+            "@c: counter();\n"
+            "c();\n"
+            "println(c());\n"
+            "println(loop(100000, 0));\n"
+            "println(squares);\n"
+        );
+    };
+    auto expected = "6765\n4999950000\n2\n5000050000\n[1, 4, 9]\n";
+    EXPECT_EQ(run("mod.anole"), expected);
+
+    // the shared object is loaded in place of the source of another module
+    auto mod = ModuleObject::generate(dir / "mod.anole");
+    Aot::compile(*reinterpret_cast<AnoleModuleObject *>(mod)->code(), dir / "mod.anole");
+    fs::copy_file(dir / "mod.anole", dir / "aot.anole");
+    fs::copy_file(dir / "mod.anole.so", dir / "aot.anole.so");
+    EXPECT_EQ(run("aot.anole"), expected);
+    EXPECT_TRUE(Aot::loaded());
+
+    // errors in functions compiled are located as the interpreter does
+    String error;
+    auto backup = std::cout.rdbuf();
+    try
+    {
+        execute("use inc from \"" + (dir / "aot.anole").string() + "\";\ninc(\"a\");");
+    }
+    catch (const RuntimeError &e)
+    {
+        error = e.what();
+    }
+    std::cout.rdbuf(backup);
+    EXPECT_NE(error.find("no match method"), String::npos);
+
+    fs::remove_all(dir);
+}
+
 #endif